@@ -0,0 +1,176 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef NMPP_ALLOCATION_HPP
+#define NMPP_ALLOCATION_HPP
+
+#include <cstddef>
+#include <new>
+
+namespace nmpp {
+
+struct array_allocation
+{
+	template<class T>
+	static size_t pitch(size_t width) { return width; }
+
+	template<class T>
+	static T* allocate(size_t size) { return new T[size]; }
+
+	template<class T>
+	static void deallocate(T* array, size_t size) { (void)size; delete [] array; }
+};
+
+namespace detail {
+
+inline size_t gcd(size_t a, size_t b)
+{
+	while (b != 0) {
+		size_t r = a % b;
+		a = b; b = r;
+	}
+	return a;
+}
+
+template<class T>
+void destroy(T* array, size_t size)
+{
+	while (size > 0)
+		array[--size].~T();
+}
+
+} // end namespace detail
+
+template<size_t Alignment = 64>
+struct aligned_allocation
+{
+	enum { alignment = Alignment };
+	enum { aliasing_stride = 4096 };
+
+	template<class T>
+	static size_t pitch(size_t width) {
+		const size_t step = Alignment / detail::gcd(Alignment, sizeof(T));
+		size_t result = (width + step - 1) / step * step;
+		if (result > 0 && (result * sizeof(T)) % aliasing_stride == 0)
+			result += step;
+		return result;
+	}
+
+	template<class T>
+	static T* allocate(size_t size) {
+		if (size == 0)
+			return 0;
+		char* raw = static_cast<char*>(::operator new(size * sizeof(T) + Alignment + sizeof(void*)));
+		char* aligned = raw + sizeof(void*);
+		aligned += (Alignment - reinterpret_cast<size_t>(aligned) % Alignment) % Alignment;
+		reinterpret_cast<void**>(aligned)[-1] = raw;
+
+		T* array = reinterpret_cast<T*>(aligned);
+		size_t i = 0;
+		try {
+			for (; i < size; ++i)
+				new (array + i) T;
+		} catch (...) {
+			detail::destroy(array, i);
+			::operator delete(raw);
+			throw;
+		}
+		return array;
+	}
+
+	template<class T>
+	static void deallocate(T* array, size_t size) {
+		if (array == 0)
+			return;
+		detail::destroy(array, size);
+		::operator delete(reinterpret_cast<void**>(array)[-1]);
+	}
+};
+
+namespace detail {
+
+// Installed by memory_pool.hpp. Returns a 64-byte aligned block from the
+// calling thread's current scoped_arena, or 0 if it has none.
+typedef void* (*arena_allocate_function)(size_t bytes);
+
+inline arena_allocate_function& arena_allocate_hook()
+{
+	static arena_allocate_function hook = 0;
+	return hook;
+}
+
+} // end namespace detail
+
+// For short-lived buffers inside algorithms. Takes memory from the current
+// thread's scoped_arena when memory_pool.hpp is in use and an arena is
+// active, and from the system allocator otherwise. Rows are not padded.
+struct temporary_allocation
+{
+	enum { alignment = 64 };
+
+	template<class T>
+	static size_t pitch(size_t width) { return width; }
+
+	template<class T>
+	static T* allocate(size_t size) {
+		if (size == 0)
+			return 0;
+		const detail::arena_allocate_function hook = detail::arena_allocate_hook();
+		char* block = hook ? static_cast<char*>(hook(size * sizeof(T) + alignment)) : 0;
+		char* raw = 0;
+		char* aligned;
+		if (block) {
+			aligned = block + alignment;
+		} else {
+			raw = static_cast<char*>(::operator new(size * sizeof(T) + alignment + sizeof(void*)));
+			aligned = raw + sizeof(void*);
+			aligned += (alignment - reinterpret_cast<size_t>(aligned) % alignment) % alignment;
+		}
+		reinterpret_cast<void**>(aligned)[-1] = raw;
+
+		T* array = reinterpret_cast<T*>(aligned);
+		size_t i = 0;
+		try {
+			for (; i < size; ++i)
+				new (array + i) T;
+		} catch (...) {
+			detail::destroy(array, i);
+			::operator delete(raw);
+			throw;
+		}
+		return array;
+	}
+
+	// Arena blocks are marked with a null raw pointer and are released
+	// with the arena.
+	template<class T>
+	static void deallocate(T* array, size_t size) {
+		if (array == 0)
+			return;
+		detail::destroy(array, size);
+		::operator delete(reinterpret_cast<void**>(array)[-1]);
+	}
+};
+
+template<class T, class AllocationT = array_allocation>
+class auto_matrix;
+
+} // end namespace nmpp
+
+#endif // NMPP_ALLOCATION_HPP
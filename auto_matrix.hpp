@@ -24,13 +24,14 @@
 #include <cstddef>
 
 #include <nmpp/util.hpp>
+#include <nmpp/allocation.hpp>
 
 namespace nmpp {
 
 template<class T>
 class weak_matrix;
 
-template<class T>
+template<class T, class AllocationT>
 class auto_matrix
 {
 public:
@@ -39,28 +40,54 @@ public:
 	typedef const T& const_reference;
 	typedef T* array_type;
 	typedef const T* const_array_type;
-	typedef auto_matrix<T> this_type;
+	typedef AllocationT allocation_type;
+	typedef auto_matrix<T, AllocationT> this_type;
 	typedef weak_matrix<T> matrix_ref;
 	typedef weak_matrix<typename detail::add_const<T>::type> matrix_const_ref;
+	typedef detail::dense_storage_tag storage_category;
 
 	auto_matrix()
-		: _array(0), _width(0), _height(0) { }
+		: _array(0), _width(0), _height(0), _pitch(0) { }
 	auto_matrix(size_t width, size_t height)
-		: _array(new T[width*height]), _width(width), _height(height) { }
+		: _array(allocate(row_pitch(width) * height)), _width(width), _height(height), _pitch(row_pitch(width)) { }
 	auto_matrix(size_t width, size_t height, value_type value)
-		: _array(new T[width*height]), _width(width), _height(height) {
-		std::fill(_array, _array+_width*_height, value);
+		: _array(allocate(row_pitch(width) * height)), _width(width), _height(height), _pitch(row_pitch(width)) {
+		std::fill(_array, _array+_pitch*_height, value);
 	}
 	auto_matrix(array_type array, size_t width, size_t height)
-		: _array(array), _width(width), _height(height) { }
-	~auto_matrix() { delete [] _array; }
+		: _array(array), _width(width), _height(height), _pitch(width) { }
+	auto_matrix(array_type array, size_t width, size_t height, size_t pitch)
+		: _array(array), _width(width), _height(height), _pitch(pitch) { }
+	auto_matrix(const this_type& other)
+		: _array(other._array ? allocate(row_pitch(other._width) * other._height) : 0)
+		, _width(other._width), _height(other._height), _pitch(other._array ? row_pitch(other._width) : 0) {
+		for (size_t y = 0; y < _height && _array; ++y)
+			std::copy(other._array+y*other._pitch, other._array+y*other._pitch+_width, _array+y*_pitch);
+	}
+#if __cplusplus >= 201103L
+	auto_matrix(this_type&& other) noexcept
+		: _array(other._array), _width(other._width), _height(other._height), _pitch(other._pitch) {
+		other._array = 0; other._width = other._height = other._pitch = 0;
+	}
+	this_type& operator=(this_type&& rhs) noexcept {
+		if (this != &rhs) {
+			deallocate(_array, _pitch*_height);
+			_array = rhs._array; _width = rhs._width; _height = rhs._height; _pitch = rhs._pitch;
+			rhs._array = 0; rhs._width = rhs._height = rhs._pitch = 0;
+		}
+		return *this;
+	}
+#endif
+	~auto_matrix() { deallocate(_array, _pitch*_height); }
 	this_type& operator=(const this_type& rhs) {
 		if (this != &rhs) {
-			if (_width*_height != rhs._width*rhs._height) {
+			const size_t pitch = row_pitch(rhs._width);
+			if (_pitch*_height != pitch*rhs._height) {
 				reset(rhs._width, rhs._height);
 			}
-			_width = rhs._width; _height = rhs._height;
-			std::copy(rhs._array, rhs._array+_width*_height, _array);
+			_width = rhs._width; _height = rhs._height; _pitch = pitch;
+			for (size_t y = 0; y < _height; ++y)
+				std::copy(rhs._array+y*rhs._pitch, rhs._array+y*rhs._pitch+_width, _array+y*_pitch);
 		}
 		return *this;
 	}
@@ -69,29 +96,33 @@ public:
 		swap(_array, other._array);
 		swap(_width, other._width);
 		swap(_height, other._height);
+		swap(_pitch, other._pitch);
 	}
 	void reset(array_type array, size_t width, size_t height) {
+		reset(array, width, height, width);
+	}
+	void reset(array_type array, size_t width, size_t height, size_t pitch) {
 		if (array != _array)
-			delete [] _array;
-		_array = array; _width = width; _height = height;
+			deallocate(_array, _pitch*_height);
+		_array = array; _width = width; _height = height; _pitch = pitch;
 	}
 	void reset(size_t width, size_t height) {
 		if (width*height > 0)
-			reset(new T[width*height], width, height);
+			reset(allocate(row_pitch(width)*height), width, height, row_pitch(width));
 		else
 			reset();
 	}
 	void reset(size_t width, size_t height, value_type value) {
 		reset(width, height);
-		std::fill(_array, _array+_width*_height, value);
+		std::fill(_array, _array+_pitch*_height, value);
 	}
 	void reset() {
-		delete [] _array;
-		_array = 0; _width = _height = 0;
+		deallocate(_array, _pitch*_height);
+		_array = 0; _width = _height = _pitch = 0;
 	}
 	array_type release() {
 		array_type tmp = _array;
-		_array = 0; _width = _height = 0;
+		_array = 0; _width = _height = _pitch = 0;
 		return tmp;
 	}
 
@@ -99,13 +130,18 @@ public:
 		assert(_array != 0);
 		assert(x < _width);
 		assert(y < _height);
-		return _array[y * _width + x];
+		return _array[y * _pitch + x];
 	}
 	const_reference operator()(size_t x, size_t y) const {
 		assert(_array != 0);
 		assert(x < _width);
 		assert(y < _height);
-		return _array[y * _width + x];
+		return _array[y * _pitch + x];
+	}
+	void read_row(size_t x, size_t y, size_t count, typename detail::remove_const<value_type>::type* output) const {
+		assert(x + count <= _width);
+		assert(y < _height);
+		std::copy(_array + y * _pitch + x, _array + y * _pitch + x + count, output);
 	}
 
 	template<class SourceT>
@@ -116,19 +152,24 @@ public:
 
 	size_t width() const { return _width; }
 	size_t height() const { return _height; }
+	size_t pitch() const { return _pitch; }
 	array_type get() { return _array; }
 	array_type get() const { return _array; }
 
 private:
+	static size_t row_pitch(size_t width) { return AllocationT::template pitch<T>(width); }
+	static array_type allocate(size_t size) { return AllocationT::template allocate<T>(size); }
+	static void deallocate(array_type array, size_t size) { AllocationT::template deallocate<T>(array, size); }
+
 	array_type _array;
-	size_t _width, _height;
+	size_t _width, _height, _pitch;
 };
 
 } // end namespace nmpp
 
 namespace std {
-	template<class T>
-	void swap(nmpp::auto_matrix<T>& lhs, nmpp::auto_matrix<T>& rhs) {
+	template<class T, class AllocationT>
+	void swap(nmpp::auto_matrix<T, AllocationT>& lhs, nmpp::auto_matrix<T, AllocationT>& rhs) {
 		lhs.swap(rhs);
 	}
 }
@@ -0,0 +1,144 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_BENCH_BENCH_HPP
+#define NMPP_BENCH_BENCH_HPP
+
+#include <complex>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+
+namespace nmpp {
+namespace bench {
+
+struct bench_case
+{
+	std::string group;
+	std::string name;
+	std::string type;
+	size_t width, height;
+	double elements;
+	double bytes;
+	std::function<std::function<void()>()> setup;
+};
+
+typedef std::vector<bench_case> suite;
+
+struct options
+{
+	options() : min_time(0.1), samples(5), counters(false) {
+		const size_t defaults[] = { 32, 128, 512, 2048, 4096 };
+		sizes.assign(defaults, defaults + 5);
+	}
+
+	std::vector<size_t> sizes;
+	double min_time;
+	size_t samples;
+	bool counters;
+};
+
+inline options& config()
+{
+	static options instance;
+	return instance;
+}
+
+inline std::vector<void (*)(suite&)>& registrars()
+{
+	static std::vector<void (*)(suite&)> instance;
+	return instance;
+}
+
+struct registrar
+{
+	explicit registrar(void (*function)(suite&)) { registrars().push_back(function); }
+};
+
+#define NMPP_BENCH_GROUP(name) \
+	static void name(nmpp::bench::suite&); \
+	static const nmpp::bench::registrar name##_registrar(&name); \
+	static void name(nmpp::bench::suite& suite)
+
+template<class T> struct type_name;
+template<> struct type_name<unsigned char> { static const char* get() { return "uint8"; } };
+template<> struct type_name<int> { static const char* get() { return "int"; } };
+template<> struct type_name<float> { static const char* get() { return "float"; } };
+template<> struct type_name<double> { static const char* get() { return "double"; } };
+template<> struct type_name< std::complex<float> > { static const char* get() { return "complex<float>"; } };
+
+template<template<class> class CasesT>
+void each_type(suite& cases)
+{
+	CasesT<unsigned char>::add(cases);
+	CasesT<int>::add(cases);
+	CasesT<float>::add(cases);
+	CasesT<double>::add(cases);
+	CasesT< std::complex<float> >::add(cases);
+}
+
+template<class T, class SetupT>
+void add(suite& cases, const std::string& group, const std::string& name, size_t width, size_t height,
+		double accesses, SetupT setup)
+{
+	bench_case c;
+	c.group = group;
+	c.name = name;
+	c.type = type_name<T>::get();
+	c.width = width;
+	c.height = height;
+	c.elements = double(width) * double(height);
+	c.bytes = c.elements * accesses * sizeof(T);
+	c.setup = setup;
+	cases.push_back(c);
+}
+
+template<class T>
+void fill(auto_matrix<T>& m, int seed)
+{
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			m(x, y) = T((x * 7 + y * 3 + seed) % 9 + 1);
+}
+
+template<class T>
+struct buffers
+{
+	buffers(size_t width, size_t height)
+		: a(width, height), b(width, height), out(width, height) {
+		fill(a, 0);
+		fill(b, 5);
+	}
+
+	auto_matrix<T> a, b, out;
+};
+
+inline void clobber(const void* p)
+{
+	asm volatile("" : : "g"(p) : "memory");
+}
+
+} // end namespace bench
+} // end namespace nmpp
+
+#endif // NMPP_BENCH_BENCH_HPP
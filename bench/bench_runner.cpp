@@ -0,0 +1,302 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "bench.hpp"
+
+using namespace nmpp::bench;
+
+namespace {
+
+struct counter_values
+{
+	std::vector<std::pair<std::string, double> > values;
+};
+
+#ifdef __linux__
+class perf_counters
+{
+public:
+	perf_counters() : _leader(-1) {
+		open("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+		open("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+		open("cache_references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES);
+		open("cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+		open("branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+	}
+	~perf_counters() {
+		for (size_t i = 0; i < _fds.size(); ++i)
+			::close(_fds[i]);
+	}
+
+	bool available() const { return _leader >= 0; }
+
+	void start() {
+		::ioctl(_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		::ioctl(_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+	counter_values stop(double iterations) {
+		::ioctl(_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+		std::vector<uint64_t> data(1 + _fds.size());
+		counter_values result;
+		if (::read(_leader, &data[0], data.size() * sizeof(uint64_t)) != static_cast<ssize_t>(data.size() * sizeof(uint64_t)))
+			return result;
+		for (size_t i = 0; i < _names.size() && i < data[0]; ++i)
+			result.values.push_back(std::make_pair(_names[i], double(data[1 + i]) / iterations));
+		return result;
+	}
+
+private:
+	void open(const char* name, uint32_t type, uint64_t config) {
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		attr.disabled = _leader < 0;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP;
+		const int fd = static_cast<int>(::syscall(__NR_perf_event_open, &attr, 0, -1, _leader, 0));
+		if (fd < 0)
+			return;
+		if (_leader < 0)
+			_leader = fd;
+		_fds.push_back(fd);
+		_names.push_back(name);
+	}
+
+	int _leader;
+	std::vector<int> _fds;
+	std::vector<std::string> _names;
+};
+#else
+class perf_counters
+{
+public:
+	bool available() const { return false; }
+	void start() { }
+	counter_values stop(double) { return counter_values(); }
+};
+#endif
+
+struct result
+{
+	const bench_case* bench;
+	size_t iterations;
+	double median, best;
+	counter_values counters;
+};
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+result measure(const bench_case& bench, perf_counters* counters)
+{
+	const std::function<void()> run = bench.setup();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	run();
+	const double once = std::max(seconds_since(start), 1e-9);
+
+	const options& opts = config();
+	result r;
+	r.bench = &bench;
+	r.iterations = std::max<size_t>(1, static_cast<size_t>(opts.min_time / opts.samples / once));
+	std::vector<double> samples;
+	for (size_t s = 0; s < opts.samples; ++s) {
+		start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < r.iterations; ++i)
+			run();
+		samples.push_back(seconds_since(start) / r.iterations);
+	}
+	std::sort(samples.begin(), samples.end());
+	r.median = samples[samples.size() / 2];
+	r.best = samples.front();
+	if (counters) {
+		counters->start();
+		for (size_t i = 0; i < r.iterations; ++i)
+			run();
+		r.counters = counters->stop(double(r.iterations));
+	}
+	return r;
+}
+
+std::string label(const bench_case& bench)
+{
+	std::ostringstream out;
+	out << bench.group << '/' << bench.name << '/' << bench.type << '/' << bench.width << 'x' << bench.height;
+	return out.str();
+}
+
+std::string quote(const std::string& text)
+{
+	std::string result = "\"";
+	for (size_t i = 0; i < text.size(); ++i) {
+		if (text[i] == '"' || text[i] == '\\')
+			result += '\\';
+		result += text[i];
+	}
+	return result + '"';
+}
+
+void write_json(std::ostream& out, const std::vector<result>& results)
+{
+	out << "{\n  \"compiler\": " << quote(__VERSION__) << ",\n";
+	out << "  \"min_time\": " << config().min_time << ",\n  \"samples\": " << config().samples << ",\n";
+	out << "  \"results\": [";
+	for (size_t i = 0; i < results.size(); ++i) {
+		const result& r = results[i];
+		const bench_case& b = *r.bench;
+		out << (i ? ",\n" : "\n") << "    {\"group\": " << quote(b.group) << ", \"name\": " << quote(b.name)
+			<< ", \"type\": " << quote(b.type) << ", \"width\": " << b.width << ", \"height\": " << b.height
+			<< ", \"iterations\": " << r.iterations << ", \"seconds\": " << r.median << ", \"best_seconds\": " << r.best
+			<< ", \"elements_per_second\": " << b.elements / r.median << ", \"bytes_per_second\": " << b.bytes / r.median;
+		if (!r.counters.values.empty()) {
+			out << ", \"counters\": {";
+			for (size_t c = 0; c < r.counters.values.size(); ++c)
+				out << (c ? ", " : "") << quote(r.counters.values[c].first) << ": " << r.counters.values[c].second;
+			out << "}";
+		}
+		out << "}";
+	}
+	out << "\n  ]\n}\n";
+}
+
+std::vector<size_t> parse_sizes(const char* text)
+{
+	std::vector<size_t> sizes;
+	std::istringstream in(text);
+	std::string item;
+	while (std::getline(in, item, ','))
+		sizes.push_back(std::strtoul(item.c_str(), 0, 10));
+	return sizes;
+}
+
+void usage(const char* name)
+{
+	std::cerr << "usage: " << name << " [--filter TEXT] [--sizes N,N,...] [--quick] [--min-time SECONDS]\n"
+		<< "       [--samples N] [--counters] [--json [FILE]] [--list]\n";
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	options& opts = config();
+	std::vector<std::string> filters;
+	std::string json;
+	bool json_stdout = false, list = false;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "--filter" && i + 1 < argc) {
+			filters.push_back(argv[++i]);
+		} else if (arg == "--sizes" && i + 1 < argc) {
+			opts.sizes = parse_sizes(argv[++i]);
+		} else if (arg == "--quick") {
+			opts.sizes = parse_sizes("64,1024");
+			opts.min_time = 0.02;
+			opts.samples = 3;
+		} else if (arg == "--min-time" && i + 1 < argc) {
+			opts.min_time = std::atof(argv[++i]);
+		} else if (arg == "--samples" && i + 1 < argc) {
+			opts.samples = std::max(1, std::atoi(argv[++i]));
+		} else if (arg == "--counters") {
+			opts.counters = true;
+		} else if (arg == "--json") {
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+				json = argv[++i];
+			else
+				json_stdout = true;
+		} else if (arg == "--list") {
+			list = true;
+		} else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+
+	suite cases;
+	for (size_t i = 0; i < registrars().size(); ++i)
+		registrars()[i](cases);
+
+	std::unique_ptr<perf_counters> counters;
+	if (opts.counters) {
+		counters.reset(new perf_counters());
+		if (!counters->available()) {
+			std::cerr << "warning: hardware counters unavailable (perf_event_open failed)\n";
+			counters.reset();
+		}
+	}
+
+	std::vector<result> results;
+	std::ostream& log = json_stdout ? std::cerr : std::cout;
+	for (size_t i = 0; i < cases.size(); ++i) {
+		const std::string name = label(cases[i]);
+		bool selected = filters.empty();
+		for (size_t f = 0; f < filters.size() && !selected; ++f)
+			selected = name.find(filters[f]) != std::string::npos;
+		if (!selected)
+			continue;
+		if (list) {
+			std::cout << name << '\n';
+			continue;
+		}
+		const result r = measure(cases[i], counters.get());
+		results.push_back(r);
+		char line[256];
+		std::snprintf(line, sizeof(line), "%-52s %12.3f us %10.3f Gelem/s %9.3f GB/s",
+			name.c_str(), r.median * 1e6, cases[i].elements / r.median * 1e-9, cases[i].bytes / r.median * 1e-9);
+		log << line;
+		for (size_t c = 0; c < r.counters.values.size(); ++c)
+			log << ' ' << r.counters.values[c].first << '=' << r.counters.values[c].second;
+		log << std::endl;
+	}
+
+	if (json_stdout)
+		write_json(std::cout, results);
+	if (!json.empty()) {
+		std::FILE* file = std::fopen(json.c_str(), "w");
+		if (!file) {
+			std::perror(json.c_str());
+			return 1;
+		}
+		std::ostringstream out;
+		write_json(out, results);
+		std::fputs(out.str().c_str(), file);
+		std::fclose(file);
+	}
+	return 0;
+}
@@ -0,0 +1,58 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/convolution.hpp>
+
+#include "bench.hpp"
+
+using namespace nmpp;
+using namespace nmpp::bench;
+
+namespace {
+
+template<class T>
+struct convolution_cases
+{
+	static void add(suite& cases) {
+		const size_t kernels[] = { 3, 5, 9, 15 };
+		for (size_t k = 0; k < 4; ++k) {
+			for (size_t i = 0; i < config().sizes.size(); ++i) {
+				const size_t n = config().sizes[i], taps = kernels[k];
+				const std::string name = "convolve_" + std::to_string(taps) + "x" + std::to_string(taps);
+				bench::add<T>(cases, "convolution", name, n, n, 2, [n, taps] {
+					std::shared_ptr< buffers<T> > m = std::make_shared< buffers<T> >(n, n);
+					std::shared_ptr< auto_matrix<T> > kernel = std::make_shared< auto_matrix<T> >(taps, taps);
+					fill(*kernel, 2);
+					return std::function<void()>([m, kernel, taps] {
+						convolve(m->a, *kernel, taps / 2, taps / 2, m->out);
+						clobber(m->out.get());
+					});
+				});
+			}
+		}
+	}
+};
+
+}
+
+NMPP_BENCH_GROUP(convolution_benchmarks)
+{
+	each_type<convolution_cases>(suite);
+}
@@ -0,0 +1,48 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+
+#include "bench.hpp"
+
+using namespace nmpp;
+using namespace nmpp::bench;
+
+namespace {
+
+template<class T>
+struct copy_cases
+{
+	static void add(suite& cases) {
+		for (size_t i = 0; i < config().sizes.size(); ++i) {
+			const size_t n = config().sizes[i];
+			bench::add<T>(cases, "copy", "copy_matrix", n, n, 2, [n] {
+				std::shared_ptr< buffers<T> > m = std::make_shared< buffers<T> >(n, n);
+				return std::function<void()>([m] { copy_matrix(m->a, m->out); clobber(m->out.get()); });
+			});
+		}
+	}
+};
+
+}
+
+NMPP_BENCH_GROUP(copy_benchmarks)
+{
+	each_type<copy_cases>(suite);
+}
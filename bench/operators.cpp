@@ -0,0 +1,80 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <complex>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/operators.hpp>
+
+#include "bench.hpp"
+
+using namespace nmpp;
+using namespace nmpp::bench;
+
+namespace {
+
+template<class T, class FunctionT>
+void add_operator(suite& cases, const char* name, double accesses, FunctionT function)
+{
+	for (size_t i = 0; i < config().sizes.size(); ++i) {
+		const size_t n = config().sizes[i];
+		bench::add<T>(cases, "operators", name, n, n, accesses, [n, function] {
+			std::shared_ptr< buffers<T> > m = std::make_shared< buffers<T> >(n, n);
+			return std::function<void()>([m, function] { function(*m); clobber(m->out.get()); });
+		});
+	}
+}
+
+template<class T, bool HasAbs = !detail::is_same<T, unsigned char>::value && !detail::is_same<T, std::complex<float> >::value>
+struct abs_case
+{
+	static void add(suite& cases) {
+		add_operator<T>(cases, "mabs", 2, [](buffers<T>& m) { mabs(m.a, m.out); });
+	}
+};
+
+template<class T>
+struct abs_case<T, false>
+{
+	static void add(suite&) { }
+};
+
+template<class T>
+struct operator_cases
+{
+	static void add(suite& cases) {
+		add_operator<T>(cases, "mplus", 3, [](buffers<T>& m) { mplus(m.a, m.b, m.out); });
+		add_operator<T>(cases, "mminus", 3, [](buffers<T>& m) { mminus(m.a, m.b, m.out); });
+		add_operator<T>(cases, "mmul", 3, [](buffers<T>& m) { mmul(m.a, m.b, m.out); });
+		add_operator<T>(cases, "mdiv", 3, [](buffers<T>& m) { mdiv(m.a, m.b, m.out); });
+		add_operator<T>(cases, "splus", 2, [](buffers<T>& m) { splus(m.a, T(3), m.out); });
+		add_operator<T>(cases, "sminus", 2, [](buffers<T>& m) { sminus(m.a, T(3), m.out); });
+		add_operator<T>(cases, "smul", 2, [](buffers<T>& m) { smul(m.a, T(3), m.out); });
+		add_operator<T>(cases, "sdiv", 2, [](buffers<T>& m) { sdiv(m.a, T(3), m.out); });
+		abs_case<T>::add(cases);
+	}
+};
+
+}
+
+NMPP_BENCH_GROUP(operator_benchmarks)
+{
+	each_type<operator_cases>(suite);
+}
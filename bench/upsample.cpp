@@ -0,0 +1,61 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/upsample.hpp>
+
+#include "bench.hpp"
+
+using namespace nmpp;
+using namespace nmpp::bench;
+
+namespace {
+
+template<class T>
+struct upsample_state
+{
+	explicit upsample_state(size_t n) : input(n / 2, n / 2), output(n, n) { fill(input, 0); }
+
+	auto_matrix<T> input, output;
+};
+
+template<class T>
+struct upsample_cases
+{
+	static void add(suite& cases) {
+		for (size_t i = 0; i < config().sizes.size(); ++i) {
+			const size_t n = config().sizes[i];
+			bench::add<T>(cases, "upsample", "upsample_nearest", n, n, 1.25, [n] {
+				std::shared_ptr< upsample_state<T> > m = std::make_shared< upsample_state<T> >(n);
+				return std::function<void()>([m] { upsample_nearest(m->input, m->output); clobber(m->output.get()); });
+			});
+			bench::add<T>(cases, "upsample", "upsample_bilinear", n, n, 1.25, [n] {
+				std::shared_ptr< upsample_state<T> > m = std::make_shared< upsample_state<T> >(n);
+				return std::function<void()>([m] { upsample_bilinear(m->input, m->output); clobber(m->output.get()); });
+			});
+		}
+	}
+};
+
+}
+
+NMPP_BENCH_GROUP(upsample_benchmarks)
+{
+	each_type<upsample_cases>(suite);
+}
@@ -0,0 +1,120 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_CACHED_HPP
+#define NMPP_CACHED_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include <nmpp/util.hpp>
+#include <nmpp/auto_matrix.hpp>
+
+namespace nmpp {
+
+namespace detail {
+
+template<class MatrixT>
+class cached_op
+{
+	typedef typename detail::const_matrix_ref<MatrixT>::type const_source_ref;
+
+public:
+	typedef typename detail::remove_const<typename MatrixT::value_type>::type value_type;
+	typedef cached_op<MatrixT> this_type;
+	typedef this_type matrix_ref;
+	typedef this_type matrix_const_ref;
+
+	enum { tile_width = detail::row_chunk_size, tile_height = 16 };
+
+	cached_op(const MatrixT& source)
+		: _state(std::make_shared<state>(source)) { }
+	cached_op(const this_type& other)
+		: _state(other._state) { }
+
+	value_type operator()(size_t x, size_t y) const {
+		assert(x < width());
+		assert(y < height());
+		prepare(x / tile_width, y / tile_height);
+		return _state->buffer(x, y);
+	}
+	void read_row(size_t x, size_t y, size_t count, value_type* output) const {
+		assert(x + count <= width());
+		assert(y < height());
+		const value_type* row = _state->buffer.get() + y * _state->buffer.pitch();
+		for (size_t end = x + count; x < end; ) {
+			const size_t next = std::min(end, (x / tile_width + 1) * tile_width);
+			prepare(x / tile_width, y / tile_height);
+			output = std::copy(row + x, row + next, output);
+			x = next;
+		}
+	}
+
+	size_t width() const { return _state->buffer.width(); }
+	size_t height() const { return _state->buffer.height(); }
+
+private:
+	struct state
+	{
+		state(const MatrixT& source)
+			: source(source), buffer(source.width(), source.height())
+			, tiles_x((source.width() + tile_width - 1) / tile_width)
+			, ready(new std::atomic<bool>[tiles_x * ((source.height() + tile_height - 1) / tile_height)]())
+			, once(new std::once_flag[tiles_x * ((source.height() + tile_height - 1) / tile_height)]) { }
+
+		const_source_ref source;
+		auto_matrix<value_type> buffer;
+		size_t tiles_x;
+		std::unique_ptr<std::atomic<bool>[]> ready;
+		std::unique_ptr<std::once_flag[]> once;
+	};
+
+	void prepare(size_t tx, size_t ty) const {
+		state& s = *_state;
+		const size_t tile = ty * s.tiles_x + tx;
+		if (s.ready[tile].load(std::memory_order_acquire))
+			return;
+		std::call_once(s.once[tile], [&s, tile, tx, ty] {
+			const size_t x0 = tx * tile_width, y0 = ty * tile_height;
+			const size_t count = std::min<size_t>(tile_width, s.buffer.width() - x0);
+			const size_t y1 = std::min<size_t>(y0 + tile_height, s.buffer.height());
+			for (size_t y = y0; y < y1; ++y)
+				detail::read_row(s.source, x0, y, count, s.buffer.get() + y * s.buffer.pitch() + x0);
+			s.ready[tile].store(true, std::memory_order_release);
+		});
+	}
+
+	std::shared_ptr<state> _state;
+};
+
+} // end namespace detail
+
+template<class MatrixT>
+detail::cached_op<MatrixT>
+cached(const MatrixT& matrix)
+{
+	return detail::cached_op<MatrixT>(matrix);
+}
+
+} // end namespace nmpp
+
+#endif // NMPP_CACHED_HPP
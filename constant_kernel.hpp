@@ -0,0 +1,260 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_CONSTANT_KERNEL_HPP
+#define NMPP_CONSTANT_KERNEL_HPP
+
+#include <cassert>
+#include <algorithm>
+#include <cstddef>
+
+#include <nmpp/util.hpp>
+#include <nmpp/convolution.hpp>
+
+namespace nmpp {
+
+template<size_t W, size_t H, int... Taps>
+class constant_kernel
+{
+	static_assert(W * H == sizeof...(Taps), "constant_kernel needs W * H taps");
+
+public:
+	typedef int value_type;
+	typedef constant_kernel<W, H, Taps...> this_type;
+	typedef this_type matrix_ref;
+	typedef this_type matrix_const_ref;
+
+	enum { static_width = W, static_height = H };
+
+	static constexpr int taps[W * H] = { Taps... };
+
+	static constexpr bool row_nonzero(size_t v, size_t u = 0) {
+		return u < W && (taps[v * W + u] != 0 || row_nonzero(v, u + 1));
+	}
+
+	value_type operator()(size_t x, size_t y) const {
+		assert(x < W);
+		assert(y < H);
+		return taps[y * W + x];
+	}
+
+	static size_t width() { return W; }
+	static size_t height() { return H; }
+};
+
+template<size_t W, size_t H, int... Taps>
+constexpr int constant_kernel<W, H, Taps...>::taps[W * H];
+
+typedef constant_kernel<3, 3, -1, 0, 1, -2, 0, 2, -1, 0, 1> sobel_x;
+typedef constant_kernel<3, 3, -1, -2, -1, 0, 0, 0, 1, 2, 1> sobel_y;
+typedef constant_kernel<3, 3, -3, 0, 3, -10, 0, 10, -3, 0, 3> scharr_x;
+typedef constant_kernel<3, 3, -3, -10, -3, 0, 0, 0, 3, 10, 3> scharr_y;
+typedef constant_kernel<3, 3, 0, 1, 0, 1, -4, 1, 0, 1, 0> laplacian;
+typedef constant_kernel<3, 3, 1, 2, 1, 2, 4, 2, 1, 2, 1> binomial;
+
+namespace detail {
+
+template<int C>
+struct constant_tap
+{
+	template<class T, class U>
+	static void apply(T& sum, const U& value) { sum += T(C) * value; }
+};
+
+template<>
+struct constant_tap<0>
+{
+	template<class T, class U>
+	static void apply(T&, const U&) { }
+};
+
+template<>
+struct constant_tap<1>
+{
+	template<class T, class U>
+	static void apply(T& sum, const U& value) { sum += value; }
+};
+
+template<>
+struct constant_tap<-1>
+{
+	template<class T, class U>
+	static void apply(T& sum, const U& value) { sum -= value; }
+};
+
+template<class KernelT, size_t Offset, size_t U, size_t W>
+struct constant_taps
+{
+	enum { coefficient = KernelT::taps[Offset + U] };
+
+	template<class T>
+	static void accumulate(T& sum, const T* line) {
+		constant_tap<coefficient>::apply(sum, line[U]);
+		constant_taps<KernelT, Offset, U + 1, W>::accumulate(sum, line);
+	}
+	template<class T, class InputT>
+	static void accumulate(T& sum, const InputT& input, size_t x, size_t y) {
+		if (coefficient != 0)
+			constant_tap<coefficient>::apply(sum, input(x + U, y));
+		constant_taps<KernelT, Offset, U + 1, W>::accumulate(sum, input, x, y);
+	}
+};
+
+template<class KernelT, size_t Offset, size_t W>
+struct constant_taps<KernelT, Offset, W, W>
+{
+	template<class T>
+	static void accumulate(T&, const T*) { }
+	template<class T, class InputT>
+	static void accumulate(T&, const InputT&, size_t, size_t) { }
+};
+
+template<class InputT>
+void load_clamped_line(const InputT& input, size_t x, size_t y, size_t anchor_x, size_t span,
+		typename remove_const<typename InputT::value_type>::type* line)
+{
+	typedef typename remove_const<typename InputT::value_type>::type value_type;
+	const size_t begin = std::min(span, x < anchor_x ? anchor_x - x : 0);
+	const size_t end = std::max(begin, std::min(span, input.width() + anchor_x - x));
+	if (begin > 0)
+		std::fill(line, line + begin, value_type(input(0, y)));
+	if (begin < end)
+		read_row(input, x + begin - anchor_x, y, end - begin, line + begin);
+	if (end < span)
+		std::fill(line + end, line + span, value_type(input(input.width() - 1, y)));
+}
+
+template<class KernelT, size_t V = 0, size_t H = KernelT::static_height>
+struct constant_rows
+{
+	enum { W = KernelT::static_width };
+
+	template<class T, class InputT>
+	static void accumulate(T& sum, const InputT& input, size_t x, size_t y) {
+		constant_taps<KernelT, V * W, 0, W>::accumulate(sum, input, x, y + V);
+		constant_rows<KernelT, V + 1, H>::accumulate(sum, input, x, y);
+	}
+	template<class T, class InputT>
+	static void read_row(const InputT& input, size_t x, size_t y, size_t anchor_x, size_t anchor_y,
+			size_t count, T* line, T* output) {
+		if (KernelT::row_nonzero(V)) {
+			load_clamped_line(input, x, clamp_index(y + V, anchor_y, input.height()), anchor_x, count + W - 1, line);
+			for (size_t i = 0; i < count; ++i) {
+				T sum = output[i];
+				constant_taps<KernelT, V * W, 0, W>::accumulate(sum, static_cast<const T*>(line + i));
+				output[i] = sum;
+			}
+		}
+		constant_rows<KernelT, V + 1, H>::read_row(input, x, y, anchor_x, anchor_y, count, line, output);
+	}
+};
+
+template<class KernelT, size_t H>
+struct constant_rows<KernelT, H, H>
+{
+	template<class T, class InputT>
+	static void accumulate(T&, const InputT&, size_t, size_t) { }
+	template<class T, class InputT>
+	static void read_row(const InputT&, size_t, size_t, size_t, size_t, size_t, T*, T*) { }
+};
+
+template<class InputT>
+class clamped_input
+{
+public:
+	typedef typename remove_const<typename InputT::value_type>::type value_type;
+
+	clamped_input(const InputT& input, size_t anchor_x, size_t anchor_y)
+		: _input(input), _anchor_x(anchor_x), _anchor_y(anchor_y) { }
+
+	value_type operator()(size_t x, size_t y) const {
+		return _input(clamp_index(x, _anchor_x, _input.width()), clamp_index(y, _anchor_y, _input.height()));
+	}
+
+private:
+	const InputT& _input;
+	const size_t _anchor_x, _anchor_y;
+};
+
+template<class InputT, size_t W, size_t H, int... Taps>
+class convolve_op< InputT, constant_kernel<W, H, Taps...> >
+{
+	typedef typename detail::const_matrix_ref<InputT>::type const_input_ref;
+	typedef constant_kernel<W, H, Taps...> kernel_type;
+
+public:
+
+	typedef typename InputT::value_type value_type;
+	typedef convolve_op<InputT, kernel_type> this_type;
+	typedef this_type matrix_ref;
+	typedef this_type matrix_const_ref;
+
+	convolve_op(const InputT& input, const kernel_type&, size_t anchor_x, size_t anchor_y)
+		: _input(input), _anchor_x(anchor_x), _anchor_y(anchor_y)
+	{
+		assert(anchor_x < W);
+		assert(anchor_y < H);
+	}
+
+	value_type operator()(size_t x, size_t y) const {
+		value_type result = 0;
+		if (x >= _anchor_x && x + W <= width() + _anchor_x && y >= _anchor_y && y + H <= height() + _anchor_y)
+			constant_rows<kernel_type>::accumulate(result, _input, x - _anchor_x, y - _anchor_y);
+		else
+			constant_rows<kernel_type>::accumulate(result, clamped_input<const_input_ref>(_input, _anchor_x, _anchor_y), x, y);
+		return result;
+	}
+	void read_row(size_t x, size_t y, size_t count, value_type* output) const {
+		value_type line[row_chunk_size + W - 1];
+		for (size_t chunk = 0; chunk < count; chunk += row_chunk_size) {
+			const size_t n = std::min<size_t>(row_chunk_size, count - chunk);
+			std::fill(output + chunk, output + chunk + n, value_type(0));
+			constant_rows<kernel_type>::read_row(_input, x + chunk, y, _anchor_x, _anchor_y, n, line, output + chunk);
+		}
+	}
+
+	size_t width() const { return _input.width(); }
+	size_t height() const { return _input.height(); }
+	const const_input_ref& input() const { return _input; }
+	kernel_type kernel() const { return kernel_type(); }
+	size_t anchor_x() const { return _anchor_x; }
+	size_t anchor_y() const { return _anchor_y; }
+
+private:
+	const_input_ref _input;
+	const size_t _anchor_x, _anchor_y;
+};
+
+} // end namespace detail
+
+template<class InputT, size_t W, size_t H, int... Taps, class OutputT>
+void convolve(const InputT& input, const constant_kernel<W, H, Taps...>& kernel, size_t anchor_x, size_t anchor_y, OutputT& output)
+{
+	assert(input.width() <= output.width());
+	assert(input.height() <= output.height());
+
+	NMPP_INSTRUMENT("convolve", input.width() * input.height(),
+		input.width() * input.height() * sizeof(typename InputT::value_type),
+		input.width() * input.height() * sizeof(typename OutputT::value_type));
+
+	copy_matrix(convolve(input, kernel, anchor_x, anchor_y), output);
+}
+
+} // end namespace nmpp
+
+#endif // NMPP_CONSTANT_KERNEL_HPP
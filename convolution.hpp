@@ -21,13 +21,36 @@
 
 #include <cstddef>
 #include <cassert>
+#include <cmath>
+#include <limits>
+#include <algorithm>
 
 #include <nmpp/util.hpp>
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/static_matrix.hpp>
+#include <nmpp/fft.hpp>
 
 namespace nmpp {
 
 namespace detail {
 
+inline size_t clamp_index(size_t i, size_t anchor, size_t size)
+{
+	if (i < anchor)
+		return 0;
+	else if (i >= size + anchor)
+		return size - 1;
+	else
+		return i - anchor;
+}
+
+inline void interior_range(size_t size, size_t taps, size_t anchor, size_t& begin, size_t& end)
+{
+	begin = end = std::min(anchor, size);
+	if (size + anchor + 1 > taps + begin)
+		end = size + anchor + 1 - taps;
+}
+
 template<class InputT, class KernelT>
 class convolve_op
 {
@@ -53,29 +76,56 @@ public:
 	value_type operator()(size_t x, size_t y) const {
 		value_type result = 0;
 		for (size_t v = 0; v < _kernel.height(); ++v) {
+			size_t iy = clamp_index(y + v, _anchor_y, height());
 			for (size_t u = 0; u < _kernel.width(); ++u) {
-				size_t ix = 0;
-				if (x + u < _anchor_x)
-					ix = 0;
-				else if (x + u >= width() + _anchor_x)
-					ix = width() - 1;
-				else
-					ix = x + u - _anchor_x;
-				size_t iy = 0;
-				if (y + v < _anchor_y)
-					iy = 0;
-				else if (y + v >= height() + _anchor_y)
-					iy = height() - 1;
-				else
-					iy = y + v - _anchor_y;
+				size_t ix = clamp_index(x + u, _anchor_x, width());
 				result += _kernel(u, v) * _input(ix, iy);
 			}
 		}
 		return result;
 	}
+	// Works on chunks of row_chunk_size outputs and row_chunk_taps kernel
+	// columns at a time, so the input line always fits on the stack.
+	void read_row(size_t x, size_t y, size_t count, value_type* output) const {
+		enum { row_chunk_taps = 64 };
+		const size_t taps = _kernel.width();
+		value_type line[row_chunk_size + row_chunk_taps - 1];
+
+		std::fill(output, output + count, value_type(0));
+		for (size_t chunk = 0; chunk < count; chunk += row_chunk_size) {
+			const size_t n = std::min<size_t>(row_chunk_size, count - chunk);
+			value_type* out = output + chunk;
+			for (size_t u0 = 0; u0 < taps; u0 += row_chunk_taps) {
+				const size_t tn = std::min<size_t>(row_chunk_taps, taps - u0);
+				const size_t x0 = x + chunk + u0;
+				const size_t span = n + tn - 1;
+				const size_t begin = std::min(span, x0 < _anchor_x ? _anchor_x - x0 : 0);
+				const size_t end = x0 >= width() + _anchor_x ? begin
+					: std::max(begin, std::min(span, width() + _anchor_x - x0));
+				for (size_t v = 0; v < _kernel.height(); ++v) {
+					const size_t iy = clamp_index(y + v, _anchor_y, height());
+					if (begin > 0)
+						std::fill(line, line + begin, value_type(_input(0, iy)));
+					if (begin < end)
+						detail::read_row(_input, x0 + begin - _anchor_x, iy, end - begin, line + begin);
+					if (end < span)
+						std::fill(line + end, line + span, value_type(_input(width() - 1, iy)));
+					for (size_t u = 0; u < tn; ++u) {
+						const typename KernelT::value_type weight = _kernel(u0 + u, v);
+						for (size_t i = 0; i < n; ++i)
+							out[i] += weight * line[i + u];
+					}
+				}
+			}
+		}
+	}
 
 	size_t width() const { return _input.width(); }
 	size_t height() const { return _input.height(); }
+	const const_input_ref& input() const { return _input; }
+	const const_kernel_ref& kernel() const { return _kernel; }
+	size_t anchor_x() const { return _anchor_x; }
+	size_t anchor_y() const { return _anchor_y; }
 
 private:
 	const_input_ref _input;
@@ -83,6 +133,308 @@ private:
 	const size_t _anchor_x, _anchor_y;
 };
 
+template<size_t U, size_t W>
+struct unrolled_taps
+{
+	template<class T, class KernelValueT>
+	static void accumulate(T& result, const KernelValueT* kernel, const T* line) {
+		result += kernel[U] * line[U];
+		unrolled_taps<U + 1, W>::accumulate(result, kernel, line);
+	}
+	template<class T, class KernelValueT, class InputT>
+	static void accumulate(T& result, const KernelValueT* kernel, const InputT& input, size_t x, size_t y) {
+		result += kernel[U] * input(x + U, y);
+		unrolled_taps<U + 1, W>::accumulate(result, kernel, input, x, y);
+	}
+};
+
+template<size_t W>
+struct unrolled_taps<W, W>
+{
+	template<class T, class KernelValueT>
+	static void accumulate(T&, const KernelValueT*, const T*) { }
+	template<class T, class KernelValueT, class InputT>
+	static void accumulate(T&, const KernelValueT*, const InputT&, size_t, size_t) { }
+};
+
+template<size_t V, size_t W, size_t H>
+struct unrolled_kernel
+{
+	template<class T, class KernelValueT, class InputT>
+	static void accumulate(T& result, const KernelValueT* kernel, const InputT& input, size_t x, size_t y) {
+		unrolled_taps<0, W>::accumulate(result, kernel + V * W, input, x, y + V);
+		unrolled_kernel<V + 1, W, H>::accumulate(result, kernel, input, x, y);
+	}
+};
+
+template<size_t W, size_t H>
+struct unrolled_kernel<H, W, H>
+{
+	template<class T, class KernelValueT, class InputT>
+	static void accumulate(T&, const KernelValueT*, const InputT&, size_t, size_t) { }
+};
+
+template<class InputT, class K, size_t W, size_t H>
+class convolve_op< InputT, static_matrix<K, W, H> >
+{
+	typedef typename detail::const_matrix_ref<InputT>::type const_input_ref;
+	typedef static_matrix<K, W, H> kernel_type;
+
+public:
+
+	typedef typename InputT::value_type value_type;
+	typedef convolve_op<InputT, kernel_type> this_type;
+	typedef this_type matrix_ref;
+	typedef this_type matrix_const_ref;
+
+	convolve_op(const InputT& input, const kernel_type& kernel, size_t anchor_x, size_t anchor_y)
+		: _input(input), _kernel(kernel), _anchor_x(anchor_x), _anchor_y(anchor_y)
+	{
+		assert(anchor_x < W);
+		assert(anchor_y < H);
+	}
+
+	value_type operator()(size_t x, size_t y) const {
+		value_type result = 0;
+		if (x >= _anchor_x && x + W <= width() + _anchor_x && y >= _anchor_y && y + H <= height() + _anchor_y) {
+			unrolled_kernel<0, W, H>::accumulate(result, _kernel.get(), _input, x - _anchor_x, y - _anchor_y);
+			return result;
+		}
+		for (size_t v = 0; v < H; ++v) {
+			size_t iy = clamp_index(y + v, _anchor_y, height());
+			for (size_t u = 0; u < W; ++u) {
+				size_t ix = clamp_index(x + u, _anchor_x, width());
+				result += _kernel(u, v) * _input(ix, iy);
+			}
+		}
+		return result;
+	}
+	void read_row(size_t x, size_t y, size_t count, value_type* output) const {
+		value_type line[row_chunk_size + W - 1];
+		for (size_t chunk = 0; chunk < count; chunk += row_chunk_size) {
+			const size_t n = std::min<size_t>(row_chunk_size, count - chunk);
+			const size_t x0 = x + chunk;
+			const size_t span = n + W - 1;
+			const size_t begin = std::min(span, x0 < _anchor_x ? _anchor_x - x0 : 0);
+			const size_t end = std::max(begin, std::min(span, width() + _anchor_x - x0));
+			value_type* out = output + chunk;
+
+			std::fill(out, out + n, value_type(0));
+			for (size_t v = 0; v < H; ++v) {
+				const size_t iy = clamp_index(y + v, _anchor_y, height());
+				if (begin > 0)
+					std::fill(line, line + begin, value_type(_input(0, iy)));
+				if (begin < end)
+					detail::read_row(_input, x0 + begin - _anchor_x, iy, end - begin, line + begin);
+				if (end < span)
+					std::fill(line + end, line + span, value_type(_input(width() - 1, iy)));
+				K weights[W];
+				std::copy(_kernel.get() + v * W, _kernel.get() + (v + 1) * W, weights);
+				for (size_t i = 0; i < n; ++i) {
+					value_type sum = out[i];
+					unrolled_taps<0, W>::accumulate(sum, weights, line + i);
+					out[i] = sum;
+				}
+			}
+		}
+	}
+
+	size_t width() const { return _input.width(); }
+	size_t height() const { return _input.height(); }
+	const const_input_ref& input() const { return _input; }
+	const kernel_type& kernel() const { return _kernel; }
+	size_t anchor_x() const { return _anchor_x; }
+	size_t anchor_y() const { return _anchor_y; }
+
+private:
+	const_input_ref _input;
+	kernel_type _kernel;
+	const size_t _anchor_x, _anchor_y;
+};
+
+template<class T, bool Exact = std::numeric_limits<T>::is_integer || !std::numeric_limits<T>::is_specialized>
+struct kernel_compare
+{
+	static bool nonzero(const T& a) { return a != T(0); }
+	static bool less(const T& a, const T& b) { (void)a; (void)b; return false; }
+	static bool equal(const T& a, const T& b, const T& scale) { (void)scale; return a == b; }
+};
+
+template<class T>
+struct kernel_compare<T, false>
+{
+	static bool nonzero(const T& a) { return a != T(0); }
+	static bool less(const T& a, const T& b) { return std::abs(a) < std::abs(b); }
+	static bool equal(const T& a, const T& b, const T& scale) {
+		return std::abs(a - b) <= 4 * std::numeric_limits<T>::epsilon() * std::abs(scale);
+	}
+};
+
+template<class KernelT, class KernelXT, class KernelYT>
+bool separate_kernel(const KernelT& kernel, KernelXT& kernel_x, KernelYT& kernel_y)
+{
+	typedef typename remove_const<typename KernelT::value_type>::type kernel_value;
+	typedef kernel_compare<kernel_value> compare;
+
+	size_t pivot_x = 0, pivot_y = 0;
+	bool found = false;
+	for (size_t v = 0; v < kernel.height(); ++v) {
+		for (size_t u = 0; u < kernel.width(); ++u) {
+			if (!compare::nonzero(kernel(u, v)))
+				continue;
+			if (!found || compare::less(kernel(pivot_x, pivot_y), kernel(u, v))) {
+				pivot_x = u; pivot_y = v;
+				found = true;
+			}
+		}
+	}
+	if (!found)
+		return false;
+
+	const kernel_value pivot = kernel(pivot_x, pivot_y);
+	kernel_x.reset(kernel.width(), 1);
+	kernel_y.reset(1, kernel.height());
+	for (size_t u = 0; u < kernel.width(); ++u)
+		kernel_x(u, 0) = kernel(u, pivot_y);
+	for (size_t v = 0; v < kernel.height(); ++v)
+		kernel_y(0, v) = kernel(pivot_x, v) / pivot;
+
+	for (size_t v = 0; v < kernel.height(); ++v) {
+		for (size_t u = 0; u < kernel.width(); ++u) {
+			if (!compare::equal(kernel_x(u, 0) * kernel_y(0, v), kernel(u, v), pivot))
+				return false;
+		}
+	}
+	return true;
+}
+
+template<class InputT, class KernelXT, class SumT>
+void convolve_row_x_clamped(const InputT& input, const KernelXT& kernel_x, size_t anchor_x, size_t y,
+		size_t begin, size_t end, SumT* output)
+{
+	for (size_t x = begin; x < end; ++x) {
+		SumT result = 0;
+		for (size_t u = 0; u < kernel_x.width(); ++u)
+			result += kernel_x(u, 0) * input(clamp_index(x + u, anchor_x, input.width()), y);
+		output[x] = result;
+	}
+}
+
+template<class InputT, class KernelXT, class SumT>
+void convolve_row_x(const InputT& input, const KernelXT& kernel_x, size_t anchor_x, size_t y, SumT* output)
+{
+	const size_t width = input.width();
+	const size_t taps = kernel_x.width();
+	size_t begin, end;
+	interior_range(width, taps, anchor_x, begin, end);
+
+	convolve_row_x_clamped(input, kernel_x, anchor_x, y, 0, begin, output);
+	for (size_t x = begin; x < end; ++x) {
+		SumT result = 0;
+		for (size_t u = 0; u < taps; ++u)
+			result += kernel_x(u, 0) * input(x + u - anchor_x, y);
+		output[x] = result;
+	}
+	convolve_row_x_clamped(input, kernel_x, anchor_x, y, end, width, output);
+}
+
+template<class InputT, class KernelT, class OutputT>
+void convolve_direct(const InputT& input, const KernelT& kernel, size_t anchor_x, size_t anchor_y, OutputT& output)
+{
+	typedef typename remove_const<typename InputT::value_type>::type value_type;
+	typedef typename OutputT::value_type output_value;
+
+	const size_t width = input.width();
+	const size_t height = input.height();
+	assert(width <= output.width());
+	assert(height <= output.height());
+	if (width == 0 || height == 0)
+		return;
+
+	const convolve_op<InputT, KernelT> border(input, kernel, anchor_x, anchor_y);
+	size_t begin_x, end_x, begin_y, end_y;
+	interior_range(width, kernel.width(), anchor_x, begin_x, end_x);
+	interior_range(height, kernel.height(), anchor_y, begin_y, end_y);
+
+	auto_matrix<value_type, temporary_allocation> sums(width, 1);
+	value_type* sum = &sums(0, 0);
+	for (size_t y = 0; y < height; ++y) {
+		if (y < begin_y || y >= end_y || begin_x == end_x) {
+			for (size_t x = 0; x < width; ++x)
+				output(x, y) = static_cast<output_value>(border(x, y));
+			continue;
+		}
+
+		for (size_t x = 0; x < begin_x; ++x)
+			output(x, y) = static_cast<output_value>(border(x, y));
+
+		std::fill(sum + begin_x, sum + end_x, value_type(0));
+		for (size_t v = 0; v < kernel.height(); ++v) {
+			const size_t iy = y + v - anchor_y;
+			for (size_t u = 0; u < kernel.width(); ++u) {
+				const typename KernelT::value_type weight = kernel(u, v);
+				for (size_t x = begin_x; x < end_x; ++x)
+					sum[x] += weight * input(x + u - anchor_x, iy);
+			}
+		}
+		for (size_t x = begin_x; x < end_x; ++x)
+			output(x, y) = static_cast<output_value>(sum[x]);
+
+		for (size_t x = end_x; x < width; ++x)
+			output(x, y) = static_cast<output_value>(border(x, y));
+	}
+}
+
+enum { fft_min_taps = 121, fft_max_tile = 1024 };
+
+inline size_t fft_tile_size(size_t width, size_t height, size_t kernel_width, size_t kernel_height)
+{
+	const size_t taps = std::max(kernel_width, kernel_height);
+	size_t best = 0;
+	double best_cost = 0;
+	for (size_t size = next_pow2(taps); ; size <<= 1) {
+		const size_t valid_x = size - kernel_width + 1, valid_y = size - kernel_height + 1;
+		const double tiles = double((width + valid_x - 1) / valid_x) * double((height + valid_y - 1) / valid_y);
+		const double cost = tiles * double(size) * double(size) * double(log2_pow2(size) + 1);
+		if (best == 0 || cost < best_cost) {
+			best = size;
+			best_cost = cost;
+		}
+		if ((valid_x >= width && valid_y >= height) || (size >= fft_max_tile && size >= 2 * taps))
+			break;
+	}
+	return best;
+}
+
+template<class InputT>
+void fft_load_tile(const InputT& input, size_t x0, size_t y0, size_t anchor_x, size_t anchor_y,
+		fft_plan::complex_type* tile, size_t size, bool imaginary)
+{
+	typedef fft_value<typename remove_const<typename InputT::value_type>::type> convert;
+	for (size_t j = 0; j < size; ++j) {
+		const size_t iy = clamp_index(y0 + j, anchor_y, input.height());
+		fft_plan::complex_type* row = tile + j * size;
+		for (size_t i = 0; i < size; ++i) {
+			const fft_plan::complex_type value = convert::to_complex(input(clamp_index(x0 + i, anchor_x, input.width()), iy));
+			row[i] = imaginary ? fft_plan::complex_type(row[i].real(), value.real()) : value;
+		}
+	}
+}
+
+template<class ValueT, class OutputT>
+void fft_store_tile(const fft_plan::complex_type* tile, size_t size, size_t x0, size_t y0,
+		size_t count_x, size_t count_y, OutputT& output, bool imaginary)
+{
+	typedef typename OutputT::value_type output_value;
+	for (size_t j = 0; j < count_y; ++j) {
+		const fft_plan::complex_type* row = tile + j * size;
+		for (size_t i = 0; i < count_x; ++i) {
+			const fft_plan::complex_type value = imaginary ? fft_plan::complex_type(row[i].imag(), 0) : row[i];
+			output(x0 + i, y0 + j) = static_cast<output_value>(fft_value<ValueT>::from_complex(value));
+		}
+	}
+}
+
 } // end namespace detail
 
 template<class InputT, class KernelT>
@@ -92,10 +444,144 @@ convolve(const InputT& input, const KernelT& kernel, size_t anchor_x, size_t anc
 	return detail::convolve_op<InputT, KernelT>(input, kernel, anchor_x, anchor_y);
 }
 
+template<class InputT, class KernelXT, class KernelYT, class OutputT>
+void convolve_separable(const InputT& input, const KernelXT& kernel_x, const KernelYT& kernel_y,
+		size_t anchor_x, size_t anchor_y, OutputT& output)
+{
+	typedef typename detail::remove_const<typename InputT::value_type>::type value_type;
+	typedef typename detail::remove_const<typename KernelXT::value_type>::type kernel_value;
+	// Integer images with fractional kernels keep the intermediate rows in
+	// the kernel type, so only the final store rounds.
+	typedef typename detail::if_c<
+		std::numeric_limits<value_type>::is_integer && !std::numeric_limits<kernel_value>::is_integer,
+		kernel_value, value_type
+	>::type sum_type;
+
+	NMPP_INSTRUMENT("convolve_separable", input.width() * input.height(),
+		input.width() * input.height() * sizeof(typename InputT::value_type)
+			+ (kernel_x.width() + kernel_y.height()) * sizeof(typename KernelXT::value_type),
+		input.width() * input.height() * sizeof(typename OutputT::value_type));
+
+	const size_t width = input.width();
+	const size_t height = input.height();
+	const size_t taps = kernel_y.height();
+	assert(kernel_x.height() == 1);
+	assert(kernel_y.width() == 1);
+	assert(anchor_x < kernel_x.width());
+	assert(anchor_y < taps);
+	assert(width <= output.width());
+	assert(height <= output.height());
+	if (width == 0 || height == 0)
+		return;
+
+	auto_matrix<sum_type, temporary_allocation> rows(width, taps);
+	auto_matrix<sum_type, temporary_allocation> sums(width, 1);
+	size_t next_row = 0;
+	for (size_t y = 0; y < height; ++y) {
+		const size_t last_row = std::min(height - 1, y + taps - 1 - anchor_y);
+		for (; next_row <= last_row; ++next_row)
+			detail::convolve_row_x(input, kernel_x, anchor_x, next_row, &rows(0, next_row % taps));
+
+		sum_type* sum = &sums(0, 0);
+		std::fill(sum, sum + width, sum_type(0));
+		for (size_t v = 0; v < taps; ++v) {
+			const sum_type* row = &rows(0, detail::clamp_index(y + v, anchor_y, height) % taps);
+			for (size_t x = 0; x < width; ++x)
+				sum[x] += kernel_y(0, v) * row[x];
+		}
+		for (size_t x = 0; x < width; ++x)
+			output(x, y) = static_cast<typename OutputT::value_type>(sum[x]);
+	}
+}
+
+template<class InputT, class KernelT, class OutputT>
+void convolve_fft(const InputT& input, const KernelT& kernel, size_t anchor_x, size_t anchor_y, OutputT& output)
+{
+	typedef typename detail::remove_const<typename InputT::value_type>::type value_type;
+	typedef typename detail::remove_const<typename KernelT::value_type>::type kernel_value;
+	typedef detail::fft_plan::complex_type complex_type;
+
+	NMPP_INSTRUMENT("convolve_fft", input.width() * input.height(),
+		input.width() * input.height() * sizeof(typename InputT::value_type)
+			+ kernel.width() * kernel.height() * sizeof(typename KernelT::value_type),
+		input.width() * input.height() * sizeof(typename OutputT::value_type));
+
+	const size_t width = input.width();
+	const size_t height = input.height();
+	const size_t kernel_width = kernel.width();
+	const size_t kernel_height = kernel.height();
+	assert(anchor_x < kernel_width);
+	assert(anchor_y < kernel_height);
+	assert(width <= output.width());
+	assert(height <= output.height());
+	if (width == 0 || height == 0)
+		return;
+
+	const size_t size = detail::fft_tile_size(width, height, kernel_width, kernel_height);
+	const size_t valid_x = size - kernel_width + 1, valid_y = size - kernel_height + 1;
+	const detail::fft_plan plan(size);
+
+	auto_matrix<complex_type, temporary_allocation> spectrum(size, size, complex_type(0));
+	const double scale = 1.0 / (double(size) * double(size));
+	for (size_t v = 0; v < kernel_height; ++v)
+		for (size_t u = 0; u < kernel_width; ++u)
+			spectrum((size - u) % size, (size - v) % size) = scale * detail::fft_value<kernel_value>::to_complex(kernel(u, v));
+	plan.forward_2d(spectrum.get());
+
+	const bool packed = !detail::fft_value<value_type>::is_complex && !detail::fft_value<kernel_value>::is_complex;
+	const size_t tiles_x = (width + valid_x - 1) / valid_x;
+	const size_t tiles = tiles_x * ((height + valid_y - 1) / valid_y);
+	auto_matrix<complex_type, temporary_allocation> tile(size, size);
+	for (size_t t = 0; t < tiles; t += packed ? 2 : 1) {
+		const bool pair = packed && t + 1 < tiles;
+		for (size_t p = 0; p < (pair ? 2u : 1u); ++p)
+			detail::fft_load_tile(input, (t + p) % tiles_x * valid_x, (t + p) / tiles_x * valid_y,
+				anchor_x, anchor_y, tile.get(), size, p == 1);
+
+		plan.forward_2d(tile.get());
+		complex_type* data = tile.get();
+		const complex_type* weights = spectrum.get();
+		for (size_t i = 0; i < size * size; ++i) {
+			const complex_type a = data[i], w = weights[i];
+			data[i] = complex_type(a.real() * w.real() - a.imag() * w.imag(), a.real() * w.imag() + a.imag() * w.real());
+		}
+		plan.inverse_2d(tile.get());
+
+		for (size_t p = 0; p < (pair ? 2u : 1u); ++p) {
+			const size_t x0 = (t + p) % tiles_x * valid_x, y0 = (t + p) / tiles_x * valid_y;
+			detail::fft_store_tile<value_type>(tile.get(), size, x0, y0,
+				std::min(valid_x, width - x0), std::min(valid_y, height - y0), output, p == 1);
+		}
+	}
+}
+
 template<class InputT, class KernelT, class OutputT>
 void convolve(const InputT& input, const KernelT& kernel, size_t anchor_x, size_t anchor_y, OutputT& output)
 {
-	copy_matrix(convolve(input, kernel, anchor_x, anchor_y), output);
+	typedef typename detail::remove_const<typename InputT::value_type>::type value_type;
+	typedef typename detail::remove_const<typename KernelT::value_type>::type kernel_value;
+
+	NMPP_INSTRUMENT("convolve", input.width() * input.height(),
+		input.width() * input.height() * sizeof(typename InputT::value_type)
+			+ kernel.width() * kernel.height() * sizeof(typename KernelT::value_type),
+		input.width() * input.height() * sizeof(typename OutputT::value_type));
+
+	// A fractional kernel on an integer image is left to the direct path,
+	// whose per-tap rounding the lazy convolve() shares; the separable one
+	// would round differently.
+	if (kernel.width() + kernel.height() < kernel.width() * kernel.height()
+			&& (!std::numeric_limits<value_type>::is_integer || std::numeric_limits<kernel_value>::is_integer)) {
+		auto_matrix<kernel_value> kernel_x, kernel_y;
+		if (detail::separate_kernel(kernel, kernel_x, kernel_y)) {
+			convolve_separable(input, kernel_x, kernel_y, anchor_x, anchor_y, output);
+			return;
+		}
+	}
+	if (kernel.width() * kernel.height() >= detail::fft_min_taps && !std::numeric_limits<value_type>::is_integer) {
+		convolve_fft(input, kernel, anchor_x, anchor_y, output);
+		return;
+	}
+	detail::convolve_direct(input, kernel, anchor_x, anchor_y, output);
 }
 
 } // end namespace nmpp
@@ -0,0 +1,137 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_CONVOLUTION_STREAM_HPP
+#define NMPP_CONVOLUTION_STREAM_HPP
+
+#include <cassert>
+#include <algorithm>
+#include <cstddef>
+
+#include <nmpp/util.hpp>
+#include <nmpp/auto_matrix.hpp>
+
+namespace nmpp {
+
+template<class T, class KernelValueT = T>
+class convolution_stream
+{
+public:
+	typedef T value_type;
+	typedef KernelValueT kernel_value;
+
+	template<class KernelT>
+	convolution_stream(size_t width, const KernelT& kernel, size_t anchor_x, size_t anchor_y)
+		: _kernel(kernel.width(), kernel.height())
+		, _rows(width + kernel.width() - 1, kernel.height())
+		, _line(width, 1)
+		, _width(width), _anchor_x(anchor_x), _anchor_y(anchor_y)
+		, _pushed(0), _popped(0), _finished(false)
+	{
+		assert(width > 0);
+		assert(anchor_x < kernel.width());
+		assert(anchor_y < kernel.height());
+		copy_matrix(kernel, _kernel);
+	}
+
+	size_t width() const { return _width; }
+	size_t rows_pushed() const { return _pushed; }
+	size_t rows_popped() const { return _popped; }
+
+	bool ready() const {
+		if (_finished)
+			return _popped < _pushed;
+		return _popped + _kernel.height() <= _pushed + _anchor_y;
+	}
+	bool done() const { return _finished && _popped == _pushed; }
+
+	void push_row(const value_type* row) {
+		assert(!_finished);
+		assert(!ready());
+		value_type* line = slot(_pushed);
+		std::copy(row, row + _width, line + _anchor_x);
+		pad(line);
+		++_pushed;
+	}
+	template<class InputT>
+	void push_row(const InputT& input, size_t y) {
+		assert(!_finished);
+		assert(!ready());
+		assert(input.width() == _width);
+		value_type* line = slot(_pushed);
+		detail::read_row(input, 0, y, _width, line + _anchor_x);
+		pad(line);
+		++_pushed;
+	}
+
+	void finish() {
+		assert(_pushed > 0);
+		_finished = true;
+	}
+
+	void pop_row(value_type* output) {
+		assert(ready());
+		const size_t taps = _kernel.width();
+		std::fill(output, output + _width, value_type(0));
+		for (size_t v = 0; v < _kernel.height(); ++v) {
+			const value_type* line = slot(source_row(_popped + v));
+			for (size_t u = 0; u < taps; ++u) {
+				const kernel_value weight = _kernel(u, v);
+				for (size_t i = 0; i < _width; ++i)
+					output[i] += weight * line[i + u];
+			}
+		}
+		++_popped;
+	}
+	template<class OutputT>
+	void pop_row(OutputT& output, size_t y) {
+		assert(output.width() >= _width);
+		value_type* row = _line.get();
+		pop_row(row);
+		for (size_t x = 0; x < _width; ++x)
+			output(x, y) = static_cast<typename OutputT::value_type>(row[x]);
+	}
+
+private:
+	value_type* slot(size_t row) {
+		return _rows.get() + row % _rows.height() * _rows.pitch();
+	}
+	const value_type* slot(size_t row) const {
+		return _rows.get() + row % _rows.height() * _rows.pitch();
+	}
+	size_t source_row(size_t row) const {
+		if (row < _anchor_y)
+			return 0;
+		return std::min(row - _anchor_y, _pushed - 1);
+	}
+	void pad(value_type* line) const {
+		std::fill(line, line + _anchor_x, line[_anchor_x]);
+		std::fill(line + _anchor_x + _width, line + _rows.width(), line[_anchor_x + _width - 1]);
+	}
+
+	auto_matrix<kernel_value> _kernel;
+	auto_matrix<value_type> _rows;
+	auto_matrix<value_type> _line;
+	size_t _width, _anchor_x, _anchor_y;
+	size_t _pushed, _popped;
+	bool _finished;
+};
+
+} // end namespace nmpp
+
+#endif // NMPP_CONVOLUTION_STREAM_HPP
@@ -0,0 +1,155 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_FFT_HPP
+#define NMPP_FFT_HPP
+
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <nmpp/transpose.hpp>
+
+namespace nmpp {
+
+namespace detail {
+
+inline size_t next_pow2(size_t n)
+{
+	size_t result = 1;
+	while (result < n)
+		result <<= 1;
+	return result;
+}
+
+inline size_t log2_pow2(size_t n)
+{
+	size_t result = 0;
+	while ((size_t(1) << result) < n)
+		++result;
+	return result;
+}
+
+class fft_plan
+{
+public:
+	typedef std::complex<double> complex_type;
+
+	explicit fft_plan(size_t size)
+		: _size(size), _twiddles(size / 2), _reverse(size)
+	{
+		assert(size > 0 && (size & (size - 1)) == 0);
+		const double pi = 3.14159265358979323846;
+		for (size_t k = 0; k < size / 2; ++k)
+			_twiddles[k] = complex_type(std::cos(2 * pi * k / size), -std::sin(2 * pi * k / size));
+		const size_t bits = log2_pow2(size);
+		for (size_t i = 0; i < size; ++i) {
+			size_t r = 0;
+			for (size_t b = 0; b < bits; ++b)
+				r |= ((i >> b) & 1) << (bits - 1 - b);
+			_reverse[i] = r;
+		}
+	}
+
+	size_t size() const { return _size; }
+
+	void forward(complex_type* data) const {
+		for (size_t i = 0; i < _size; ++i)
+			if (i < _reverse[i])
+				std::swap(data[i], data[_reverse[i]]);
+		for (size_t half = 1, step = _size / 2; half < _size; half <<= 1, step >>= 1) {
+			for (size_t i = 0; i < _size; i += 2 * half) {
+				for (size_t j = 0; j < half; ++j) {
+					const complex_type w = _twiddles[j * step];
+					const complex_type a = data[i + j];
+					const complex_type c = data[i + j + half];
+					const complex_type b(c.real() * w.real() - c.imag() * w.imag(),
+						c.real() * w.imag() + c.imag() * w.real());
+					data[i + j] = a + b;
+					data[i + j + half] = a - b;
+				}
+			}
+		}
+	}
+
+	void inverse(complex_type* data) const {
+		for (size_t i = 0; i < _size; ++i)
+			data[i] = std::conj(data[i]);
+		forward(data);
+		for (size_t i = 0; i < _size; ++i)
+			data[i] = std::conj(data[i]);
+	}
+
+	void forward_2d(complex_type* data) const {
+		for (size_t y = 0; y < _size; ++y)
+			forward(data + y * _size);
+		transpose_square(data, _size, _size);
+		for (size_t y = 0; y < _size; ++y)
+			forward(data + y * _size);
+	}
+
+	void inverse_2d(complex_type* data) const {
+		for (size_t y = 0; y < _size; ++y)
+			inverse(data + y * _size);
+		transpose_square(data, _size, _size);
+		for (size_t y = 0; y < _size; ++y)
+			inverse(data + y * _size);
+	}
+
+private:
+	size_t _size;
+	std::vector<complex_type> _twiddles;
+	std::vector<size_t> _reverse;
+};
+
+template<class T, bool Integer = std::numeric_limits<T>::is_integer>
+struct fft_value
+{
+	enum { is_complex = false };
+	static std::complex<double> to_complex(const T& value) { return std::complex<double>(double(value), 0); }
+	static T from_complex(const std::complex<double>& value) { return static_cast<T>(value.real()); }
+};
+
+template<class T>
+struct fft_value<T, true>
+{
+	enum { is_complex = false };
+	static std::complex<double> to_complex(const T& value) { return std::complex<double>(double(value), 0); }
+	static T from_complex(const std::complex<double>& value) { return static_cast<T>(std::floor(value.real() + 0.5)); }
+};
+
+template<class T, bool Integer>
+struct fft_value<std::complex<T>, Integer>
+{
+	enum { is_complex = true };
+	static std::complex<double> to_complex(const std::complex<T>& value) {
+		return std::complex<double>(double(value.real()), double(value.imag()));
+	}
+	static std::complex<T> from_complex(const std::complex<double>& value) {
+		return std::complex<T>(static_cast<T>(value.real()), static_cast<T>(value.imag()));
+	}
+};
+
+} // end namespace detail
+
+} // end namespace nmpp
+
+#endif // NMPP_FFT_HPP
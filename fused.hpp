@@ -0,0 +1,88 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_FUSED_HPP
+#define NMPP_FUSED_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+#include <nmpp/util.hpp>
+
+namespace nmpp {
+
+namespace detail {
+
+template<size_t I, size_t N>
+struct fused_rows
+{
+	template<class OutputsT, class InputsT>
+	static void check(const OutputsT& outputs, const InputsT& inputs, size_t width, size_t height) {
+		assert(std::get<I>(inputs).width() == width);
+		assert(std::get<I>(inputs).height() == height);
+		assert(std::get<I>(outputs).width() >= width);
+		assert(std::get<I>(outputs).height() >= height);
+		fused_rows<I + 1, N>::check(outputs, inputs, width, height);
+	}
+
+	template<class OutputsT, class InputsT>
+	static void copy(OutputsT& outputs, const InputsT& inputs, size_t begin, size_t end) {
+		copy_rows(std::get<I>(inputs), std::get<I>(outputs), begin, end);
+		fused_rows<I + 1, N>::copy(outputs, inputs, begin, end);
+	}
+
+	template<class TupleT>
+	static size_t element_bytes(const TupleT& matrices) {
+		return sizeof(typename std::decay<decltype(std::get<I>(matrices))>::type::value_type)
+			+ fused_rows<I + 1, N>::element_bytes(matrices);
+	}
+};
+
+template<size_t N>
+struct fused_rows<N, N>
+{
+	template<class OutputsT, class InputsT>
+	static void check(const OutputsT&, const InputsT&, size_t, size_t) { }
+	template<class OutputsT, class InputsT>
+	static void copy(OutputsT&, const InputsT&, size_t, size_t) { }
+	template<class TupleT>
+	static size_t element_bytes(const TupleT&) { return 0; }
+};
+
+} // end namespace detail
+
+template<class... OutputTs, class InputT, class... InputTs>
+void copy_matrices(std::tuple<OutputTs&...> outputs, const InputT& input, const InputTs&... inputs)
+{
+	static_assert(sizeof...(OutputTs) == sizeof...(InputTs) + 1, "copy_matrices needs one output per input");
+	typedef detail::fused_rows<0, sizeof...(OutputTs)> rows;
+	const std::tuple<const InputT&, const InputTs&...> sources(input, inputs...);
+	const size_t height = input.height();
+	rows::check(outputs, sources, input.width(), height);
+	NMPP_INSTRUMENT("copy_matrices", input.width() * height * sizeof...(OutputTs),
+		input.width() * height * rows::element_bytes(sources),
+		input.width() * height * rows::element_bytes(outputs));
+	for (size_t y = 0; y < height; ++y)
+		rows::copy(outputs, sources, y, y + 1);
+}
+
+} // end namespace nmpp
+
+#endif // NMPP_FUSED_HPP
@@ -0,0 +1,323 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_INSTRUMENTATION_HPP
+#define NMPP_INSTRUMENTATION_HPP
+
+// Instrumentation is compiled out unless NMPP_INSTRUMENTATION is defined,
+// in which case it needs C++11. Define it the same way in every translation
+// unit of a program, since it changes the bodies of inline templates.
+
+#ifndef NMPP_INSTRUMENTATION
+
+#define NMPP_INSTRUMENT(name, elements, bytes_read, bytes_written) ((void)0)
+
+#else
+
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <ios>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace nmpp {
+namespace instrumentation {
+
+// A call site is the NMPP_INSTRUMENT line inside the library, so it names
+// a kernel (one per operation and code path), not the caller's source line:
+// every user call of copy_matrix lands on the same site.
+struct call_site
+{
+	const char* name;
+	const char* file;
+	int line;
+};
+
+// Times are in seconds since the first instrumented call of the process.
+// depth is the number of enclosing instrumented calls on the same thread,
+// so nested calls (convolve -> convolve_separable) can be told apart.
+struct event
+{
+	const call_site* site;
+	double start;
+	double seconds;
+	size_t thread;
+	size_t depth;
+	size_t elements;
+	size_t bytes_read;
+	size_t bytes_written;
+};
+
+class sink
+{
+public:
+	virtual ~sink() { }
+	virtual void record(const event& e) = 0;
+};
+
+namespace detail {
+
+inline std::atomic<sink*>& current_sink()
+{
+	static std::atomic<sink*> instance(0);
+	return instance;
+}
+
+inline std::chrono::steady_clock::time_point epoch()
+{
+	static const std::chrono::steady_clock::time_point instance = std::chrono::steady_clock::now();
+	return instance;
+}
+
+inline double now()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - epoch()).count();
+}
+
+inline size_t thread_index()
+{
+	static std::atomic<size_t> next(0);
+	static thread_local size_t index = next++;
+	return index;
+}
+
+inline size_t& thread_depth()
+{
+	static thread_local size_t depth = 0;
+	return depth;
+}
+
+inline std::string site_label(const call_site& site)
+{
+	std::ostringstream out;
+	out << site.name << " (" << site.file << ':' << site.line << ')';
+	return out.str();
+}
+
+inline void write_string(std::ostream& out, const char* text)
+{
+	out << '"';
+	for (; *text; ++text) {
+		if (*text == '"' || *text == '\\')
+			out << '\\';
+		out << *text;
+	}
+	out << '"';
+}
+
+} // end namespace detail
+
+// Sinks are called from whichever thread made the call and must be
+// thread-safe. Returns the previously installed sink.
+inline sink* set_sink(sink* s)
+{
+	detail::epoch();
+	return detail::current_sink().exchange(s);
+}
+
+inline sink* get_sink()
+{
+	return detail::current_sink().load(std::memory_order_acquire);
+}
+
+// Restores the previous sink on destruction. The sink must still outlive
+// any instrumented call that is in flight on another thread at that point:
+// scope re-reads the installed sink when it finishes, but a call may have
+// loaded it just before the swap.
+class scoped_sink
+{
+public:
+	explicit scoped_sink(sink& s) : _previous(set_sink(&s)) { }
+	~scoped_sink() { set_sink(_previous); }
+
+private:
+	scoped_sink(const scoped_sink&);
+	scoped_sink& operator=(const scoped_sink&);
+
+	sink* _previous;
+};
+
+// The event goes to whichever sink is installed when the call returns, so a
+// sink that was removed while the call ran is not written to.
+class scope
+{
+public:
+	scope(const call_site& site, size_t elements, size_t bytes_read, size_t bytes_written)
+		: _active(get_sink() != 0)
+	{
+		if (!_active)
+			return;
+		_event.site = &site;
+		_event.thread = detail::thread_index();
+		_event.depth = detail::thread_depth()++;
+		_event.elements = elements;
+		_event.bytes_read = bytes_read;
+		_event.bytes_written = bytes_written;
+		_event.start = detail::now();
+	}
+	~scope() {
+		if (!_active)
+			return;
+		_event.seconds = detail::now() - _event.start;
+		--detail::thread_depth();
+		if (sink* s = get_sink())
+			s->record(_event);
+	}
+
+private:
+	scope(const scope&);
+	scope& operator=(const scope&);
+
+	bool _active;
+	event _event;
+};
+
+class callback_sink : public sink
+{
+public:
+	explicit callback_sink(const std::function<void(const event&)>& callback) : _callback(callback) { }
+
+	void record(const event& e) { _callback(e); }
+
+private:
+	std::function<void(const event&)> _callback;
+};
+
+// Times are inclusive: a convolve that dispatches to convolve_separable is
+// counted under both sites. Filter on event::depth to avoid that.
+class aggregate_sink : public sink
+{
+public:
+	struct totals
+	{
+		totals() : calls(0), seconds(0), elements(0), bytes_read(0), bytes_written(0) { }
+
+		size_t calls;
+		double seconds;
+		size_t elements;
+		size_t bytes_read;
+		size_t bytes_written;
+	};
+
+	typedef std::map<std::string, totals> snapshot_type;
+
+	void record(const event& e) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		totals& t = _totals[e.site];
+		++t.calls;
+		t.seconds += e.seconds;
+		t.elements += e.elements;
+		t.bytes_read += e.bytes_read;
+		t.bytes_written += e.bytes_written;
+	}
+
+	// Call sites are keyed as "name (file:line)" of the library kernel;
+	// template instantiations of the same call site are merged.
+	snapshot_type snapshot() const {
+		std::lock_guard<std::mutex> lock(_mutex);
+		snapshot_type result;
+		for (std::map<const call_site*, totals>::const_iterator i = _totals.begin(); i != _totals.end(); ++i) {
+			totals& t = result[detail::site_label(*i->first)];
+			t.calls += i->second.calls;
+			t.seconds += i->second.seconds;
+			t.elements += i->second.elements;
+			t.bytes_read += i->second.bytes_read;
+			t.bytes_written += i->second.bytes_written;
+		}
+		return result;
+	}
+
+	void reset() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_totals.clear();
+	}
+
+private:
+	mutable std::mutex _mutex;
+	std::map<const call_site*, totals> _totals;
+};
+
+// Collects complete ("X") events in the Chrome trace-event format, which
+// chrome://tracing and Perfetto load directly.
+class trace_sink : public sink
+{
+public:
+	explicit trace_sink(int pid = 1) : _pid(pid) { }
+
+	void record(const event& e) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_events.push_back(e);
+	}
+
+	size_t size() const {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _events.size();
+	}
+
+	void clear() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_events.clear();
+	}
+
+	// Timestamps are written in fixed-point microseconds, since the default
+	// six significant digits collapse events once the process is a second old.
+	void write(std::ostream& out) const {
+		std::lock_guard<std::mutex> lock(_mutex);
+		const std::ios_base::fmtflags flags = out.flags();
+		const std::streamsize precision = out.precision();
+		out << std::fixed << std::setprecision(3);
+		out << "{\"traceEvents\":[";
+		for (size_t i = 0; i < _events.size(); ++i) {
+			const event& e = _events[i];
+			out << (i ? ",\n" : "\n") << "{\"name\":";
+			detail::write_string(out, e.site->name);
+			out << ",\"cat\":\"nmpp\",\"ph\":\"X\",\"ts\":" << e.start * 1e6 << ",\"dur\":" << e.seconds * 1e6
+				<< ",\"pid\":" << _pid << ",\"tid\":" << e.thread << ",\"args\":{\"file\":";
+			detail::write_string(out, e.site->file);
+			out << ",\"line\":" << e.site->line << ",\"elements\":" << e.elements
+				<< ",\"bytes_read\":" << e.bytes_read << ",\"bytes_written\":" << e.bytes_written << "}}";
+		}
+		out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+		out.flags(flags);
+		out.precision(precision);
+	}
+
+private:
+	mutable std::mutex _mutex;
+	std::vector<event> _events;
+	int _pid;
+};
+
+} // end namespace instrumentation
+} // end namespace nmpp
+
+#define NMPP_INSTRUMENT(name, elements, bytes_read, bytes_written) \
+	static const ::nmpp::instrumentation::call_site nmpp_instrument_site = { name, __FILE__, __LINE__ }; \
+	const ::nmpp::instrumentation::scope nmpp_instrument_scope(nmpp_instrument_site, \
+		(elements), (bytes_read), (bytes_written))
+
+#endif // NMPP_INSTRUMENTATION
+
+#endif // NMPP_INSTRUMENTATION_HPP
@@ -0,0 +1,203 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_INTEGRAL_IMAGE_HPP
+#define NMPP_INTEGRAL_IMAGE_HPP
+
+#include <cassert>
+#include <algorithm>
+#include <cstddef>
+
+#include <nmpp/util.hpp>
+#include <nmpp/auto_matrix.hpp>
+
+namespace nmpp {
+
+namespace detail {
+
+// Table entries grow with the image area, so 8- and 16-bit inputs get 64-bit
+// entries instead of the 32-bit accumulator used elsewhere.
+template<class T>
+struct integral_accumulator : accumulator<T> { };
+template<>
+struct integral_accumulator<char> { typedef long long type; };
+template<>
+struct integral_accumulator<signed char> { typedef long long type; };
+template<>
+struct integral_accumulator<unsigned char> { typedef unsigned long long type; };
+template<>
+struct integral_accumulator<short> { typedef long long type; };
+template<>
+struct integral_accumulator<unsigned short> { typedef unsigned long long type; };
+template<class T>
+struct integral_accumulator<const T> : integral_accumulator<T> { };
+
+} // end namespace detail
+
+template<class T, class AccumulatorT = typename detail::integral_accumulator<T>::type>
+class integral_image
+{
+public:
+	typedef AccumulatorT value_type;
+	typedef integral_image<T, AccumulatorT> this_type;
+
+	integral_image() : _width(0), _height(0) { }
+	template<class InputT>
+	explicit integral_image(const InputT& input) : _width(0), _height(0) { assign(input); }
+
+	template<class InputT>
+	void assign(const InputT& input) {
+		typedef typename detail::remove_const<typename InputT::value_type>::type input_value;
+		_width = input.width();
+		_height = input.height();
+		_table.reset(_width + 1, _height + 1, value_type(0));
+		if (_width == 0)
+			return;
+		auto_matrix<input_value, temporary_allocation> buffer(_width, 1);
+		input_value* row = buffer.get();
+		for (size_t y = 0; y < _height; ++y) {
+			detail::read_row(input, 0, y, _width, row);
+			const value_type* above = _table.get() + y * _table.pitch();
+			value_type* sums = _table.get() + (y + 1) * _table.pitch();
+			value_type running = value_type(0);
+			for (size_t x = 0; x < _width; ++x) {
+				running += static_cast<value_type>(row[x]);
+				sums[x + 1] = above[x + 1] + running;
+			}
+		}
+	}
+
+	value_type operator()(size_t x, size_t y) const {
+		assert(x <= _width);
+		assert(y <= _height);
+		return _table(x, y);
+	}
+
+	value_type sum(size_t x, size_t y, size_t width, size_t height) const {
+		assert(x + width <= _width);
+		assert(y + height <= _height);
+		return _table(x + width, y + height) - _table(x, y + height) - _table(x + width, y) + _table(x, y);
+	}
+
+	size_t width() const { return _width; }
+	size_t height() const { return _height; }
+
+private:
+	auto_matrix<value_type> _table;
+	size_t _width, _height;
+};
+
+namespace detail {
+
+struct box_span {
+	size_t begin, count, weight;
+};
+
+inline size_t clamped_spans(size_t i, size_t window, size_t anchor, size_t size, box_span* spans)
+{
+	const size_t lo = i, hi = i + window;
+	const size_t inner_begin = std::min(std::max(lo, anchor), size + anchor);
+	const size_t inner_end = std::max(std::min(hi, size + anchor), inner_begin);
+	size_t n = 0;
+	if (lo < anchor) {
+		const box_span span = { 0, 1, std::min(hi, anchor) - lo };
+		spans[n++] = span;
+	}
+	if (inner_begin < inner_end) {
+		const box_span span = { inner_begin - anchor, inner_end - inner_begin, 1 };
+		spans[n++] = span;
+	}
+	if (hi > size + anchor) {
+		const box_span span = { size - 1, 1, hi - std::max(lo, size + anchor) };
+		spans[n++] = span;
+	}
+	return n;
+}
+
+template<class T, class AccumulatorT>
+AccumulatorT clamped_box_sum(const integral_image<T, AccumulatorT>& table, size_t x, size_t y,
+		size_t width, size_t height, size_t anchor_x, size_t anchor_y)
+{
+	if (x >= anchor_x && y >= anchor_y && x + width <= table.width() + anchor_x && y + height <= table.height() + anchor_y)
+		return table.sum(x - anchor_x, y - anchor_y, width, height);
+
+	box_span spans_x[3], spans_y[3];
+	const size_t nx = clamped_spans(x, width, anchor_x, table.width(), spans_x);
+	const size_t ny = clamped_spans(y, height, anchor_y, table.height(), spans_y);
+	AccumulatorT result = AccumulatorT(0);
+	for (size_t j = 0; j < ny; ++j)
+		for (size_t i = 0; i < nx; ++i)
+			result += static_cast<AccumulatorT>(spans_x[i].weight * spans_y[j].weight)
+				* table.sum(spans_x[i].begin, spans_y[j].begin, spans_x[i].count, spans_y[j].count);
+	return result;
+}
+
+} // end namespace detail
+
+template<class T, class AccumulatorT, class OutputT>
+void box_sum(const integral_image<T, AccumulatorT>& table, size_t width, size_t height,
+		size_t anchor_x, size_t anchor_y, OutputT& output)
+{
+	assert(anchor_x < width);
+	assert(anchor_y < height);
+	assert(table.width() <= output.width());
+	assert(table.height() <= output.height());
+	typedef typename OutputT::value_type output_value;
+	for (size_t y = 0; y < table.height(); ++y)
+		for (size_t x = 0; x < table.width(); ++x)
+			output(x, y) = static_cast<output_value>(detail::clamped_box_sum(table, x, y, width, height, anchor_x, anchor_y));
+}
+
+template<class InputT, class OutputT>
+void box_sum(const InputT& input, size_t width, size_t height, size_t anchor_x, size_t anchor_y, OutputT& output)
+{
+	const integral_image<typename detail::remove_const<typename InputT::value_type>::type> table(input);
+	box_sum(table, width, height, anchor_x, anchor_y, output);
+}
+
+template<class T, class AccumulatorT, class OutputT>
+void box_filter(const integral_image<T, AccumulatorT>& table, size_t width, size_t height,
+		size_t anchor_x, size_t anchor_y, OutputT& output)
+{
+	assert(anchor_x < width);
+	assert(anchor_y < height);
+	assert(table.width() <= output.width());
+	assert(table.height() <= output.height());
+	typedef typename OutputT::value_type output_value;
+	const AccumulatorT area = static_cast<AccumulatorT>(width * height);
+	for (size_t y = 0; y < table.height(); ++y)
+		for (size_t x = 0; x < table.width(); ++x)
+			output(x, y) = static_cast<output_value>(detail::clamped_box_sum(table, x, y, width, height, anchor_x, anchor_y) / area);
+}
+
+template<class InputT, class OutputT>
+void box_filter(const InputT& input, size_t width, size_t height, size_t anchor_x, size_t anchor_y, OutputT& output)
+{
+	const integral_image<typename detail::remove_const<typename InputT::value_type>::type> table(input);
+	box_filter(table, width, height, anchor_x, anchor_y, output);
+}
+
+template<class InputT, class OutputT>
+void box_filter(const InputT& input, size_t width, size_t height, OutputT& output)
+{
+	box_filter(input, width, height, width / 2, height / 2, output);
+}
+
+} // end namespace nmpp
+
+#endif // NMPP_INTEGRAL_IMAGE_HPP
@@ -0,0 +1,185 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_MATMUL_HPP
+#define NMPP_MATMUL_HPP
+
+#include <cassert>
+#include <algorithm>
+#include <cstddef>
+
+#include <nmpp/util.hpp>
+#include <nmpp/auto_matrix.hpp>
+
+namespace nmpp {
+
+namespace detail {
+
+template<class T>
+struct gemm_blocking { enum { mr = 4, nr = 4, kc = 128, mc = 64, nc = 1024 }; };
+template<>
+struct gemm_blocking<float> { enum { mr = 4, nr = 32, kc = 256, mc = 128, nc = 4096 }; };
+template<>
+struct gemm_blocking<double> { enum { mr = 4, nr = 8, kc = 256, mc = 96, nc = 2048 }; };
+
+template<class T, class MatrixT>
+void gemm_pack_a(const MatrixT& a, size_t y0, size_t p0, size_t rows, size_t depth, T* buffer)
+{
+	const size_t mr = gemm_blocking<T>::mr;
+	for (size_t ir = 0; ir < rows; ir += mr)
+		for (size_t p = 0; p < depth; ++p)
+			for (size_t i = 0; i < mr; ++i)
+				*buffer++ = ir + i < rows ? static_cast<T>(a(p0 + p, y0 + ir + i)) : T(0);
+}
+
+template<class T, class MatrixT>
+void gemm_pack_b(const MatrixT& b, size_t p0, size_t x0, size_t depth, size_t cols, T* buffer)
+{
+	const size_t nr = gemm_blocking<T>::nr;
+	for (size_t jr = 0; jr < cols; jr += nr)
+		for (size_t p = 0; p < depth; ++p)
+			for (size_t j = 0; j < nr; ++j)
+				*buffer++ = jr + j < cols ? static_cast<T>(b(x0 + jr + j, p0 + p)) : T(0);
+}
+
+template<class T>
+void gemm_micro(size_t depth, const T* a, const T* b, T* tile)
+{
+	enum { mr = gemm_blocking<T>::mr, nr = gemm_blocking<T>::nr };
+	T acc[mr][nr];
+	for (size_t i = 0; i < mr; ++i)
+		for (size_t j = 0; j < nr; ++j)
+			acc[i][j] = T(0);
+	for (size_t p = 0; p < depth; ++p, a += mr, b += nr)
+		for (size_t i = 0; i < mr; ++i)
+			for (size_t j = 0; j < nr; ++j)
+				acc[i][j] += a[i] * b[j];
+	for (size_t i = 0; i < mr; ++i)
+		for (size_t j = 0; j < nr; ++j)
+			tile[i * nr + j] = acc[i][j];
+}
+
+template<class T, class OutputT>
+void gemm_store(const T* tile, OutputT& output, size_t x0, size_t y0, size_t rows, size_t cols, bool accumulate)
+{
+	typedef typename OutputT::value_type output_value;
+	const size_t nr = gemm_blocking<T>::nr;
+	for (size_t i = 0; i < rows; ++i) {
+		for (size_t j = 0; j < cols; ++j) {
+			output_value& target = output(x0 + j, y0 + i);
+			target = accumulate ? static_cast<output_value>(target + tile[i * nr + j]) : static_cast<output_value>(tile[i * nr + j]);
+		}
+	}
+}
+
+template<class T>
+size_t gemm_pack_a_stride(size_t depth)
+{
+	enum { mr = gemm_blocking<T>::mr, mc = gemm_blocking<T>::mc };
+	return (mc + mr - 1) / mr * mr * depth;
+}
+
+template<class T, class LeftT, class OutputT>
+class gemm_row_task
+{
+public:
+	gemm_row_task(const LeftT& a, T* packed_a, const T* packed_b, OutputT& output,
+			size_t p0, size_t depth, size_t x0, size_t cols, bool accumulate)
+		: _a(a), _packed_a(packed_a), _packed_b(packed_b), _output(output)
+		, _p0(p0), _depth(depth), _x0(x0), _cols(cols), _accumulate(accumulate) { }
+
+	void operator()(size_t block) const {
+		enum { mr = gemm_blocking<T>::mr, nr = gemm_blocking<T>::nr, mc = gemm_blocking<T>::mc };
+		const size_t y0 = block * mc;
+		const size_t rows = std::min<size_t>(mc, _a.height() - y0);
+		T* packed_a = _packed_a + block * gemm_pack_a_stride<T>(_depth);
+		gemm_pack_a(_a, y0, _p0, rows, _depth, packed_a);
+		T tile[mr * nr];
+		for (size_t jr = 0; jr < _cols; jr += nr) {
+			for (size_t ir = 0; ir < rows; ir += mr) {
+				gemm_micro(_depth, packed_a + ir * _depth, _packed_b + jr * _depth, tile);
+				gemm_store(tile, _output, _x0 + jr, y0 + ir,
+					std::min<size_t>(mr, rows - ir), std::min<size_t>(nr, _cols - jr), _accumulate);
+			}
+		}
+	}
+
+private:
+	const LeftT& _a;
+	T* _packed_a;
+	const T* _packed_b;
+	OutputT& _output;
+	size_t _p0, _depth, _x0, _cols;
+	bool _accumulate;
+};
+
+struct serial_runner
+{
+	template<class FunctionT>
+	void operator()(size_t tasks, const FunctionT& function) const {
+		for (size_t i = 0; i < tasks; ++i)
+			function(i);
+	}
+};
+
+template<class LeftT, class RightT, class OutputT, class RunnerT>
+void gemm(const LeftT& a, const RightT& b, OutputT& output, const RunnerT& runner)
+{
+	typedef typename remove_const<typename LeftT::value_type>::type value_type;
+	typedef typename OutputT::value_type output_value;
+	enum { nr = gemm_blocking<value_type>::nr, kc = gemm_blocking<value_type>::kc,
+		mc = gemm_blocking<value_type>::mc, nc = gemm_blocking<value_type>::nc };
+
+	const size_t m = a.height(), k = a.width(), n = b.width();
+	assert(b.height() == k);
+	assert(output.width() >= n);
+	assert(output.height() >= m);
+	if (k == 0) {
+		for (size_t y = 0; y < m; ++y)
+			for (size_t x = 0; x < n; ++x)
+				output(x, y) = output_value(0);
+		return;
+	}
+
+	// Scratch is allocated once per call, A panels one per row block so that
+	// parallel tasks never share one, and kept out of any scoped_arena.
+	const size_t blocks = (m + mc - 1) / mc;
+	auto_matrix<value_type> packed_a(blocks * gemm_pack_a_stride<value_type>(std::min<size_t>(kc, k)), 1);
+	auto_matrix<value_type> packed_b(std::min<size_t>(nc, (n + nr - 1) / nr * nr) * std::min<size_t>(kc, k), 1);
+	for (size_t x0 = 0; x0 < n; x0 += nc) {
+		const size_t cols = std::min<size_t>(nc, n - x0);
+		for (size_t p0 = 0; p0 < k; p0 += kc) {
+			const size_t depth = std::min<size_t>(kc, k - p0);
+			gemm_pack_b(b, p0, x0, depth, cols, packed_b.get());
+			runner(blocks, gemm_row_task<value_type, LeftT, OutputT>(
+				a, packed_a.get(), packed_b.get(), output, p0, depth, x0, cols, p0 != 0));
+		}
+	}
+}
+
+} // end namespace detail
+
+template<class LeftT, class RightT, class OutputT>
+void matmul(const LeftT& a, const RightT& b, OutputT& output)
+{
+	detail::gemm(a, b, output, detail::serial_runner());
+}
+
+} // end namespace nmpp
+
+#endif // NMPP_MATMUL_HPP
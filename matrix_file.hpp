@@ -0,0 +1,135 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_MATRIX_FILE_HPP
+#define NMPP_MATRIX_FILE_HPP
+
+#include <complex>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <stdint.h>
+
+#include <nmpp/util.hpp>
+
+namespace nmpp {
+
+struct matrix_file_header
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t type;
+	uint32_t element_size;
+	uint32_t byte_order;
+	uint32_t reserved;
+	uint64_t width;
+	uint64_t height;
+	uint64_t pitch;
+	uint64_t data_offset;
+};
+
+namespace detail {
+
+enum {
+	matrix_file_version = 1,
+	matrix_file_byte_order = 0x01020304,
+	matrix_file_data_offset = 64
+};
+
+template<class T> struct matrix_file_type { enum { value = 0 }; };
+template<> struct matrix_file_type<int8_t> { enum { value = 1 }; };
+template<> struct matrix_file_type<uint8_t> { enum { value = 2 }; };
+template<> struct matrix_file_type<int16_t> { enum { value = 3 }; };
+template<> struct matrix_file_type<uint16_t> { enum { value = 4 }; };
+template<> struct matrix_file_type<int32_t> { enum { value = 5 }; };
+template<> struct matrix_file_type<uint32_t> { enum { value = 6 }; };
+template<> struct matrix_file_type<int64_t> { enum { value = 7 }; };
+template<> struct matrix_file_type<uint64_t> { enum { value = 8 }; };
+template<> struct matrix_file_type<float> { enum { value = 9 }; };
+template<> struct matrix_file_type<double> { enum { value = 10 }; };
+template<> struct matrix_file_type< std::complex<float> > { enum { value = 11 }; };
+template<> struct matrix_file_type< std::complex<double> > { enum { value = 12 }; };
+template<class T> struct matrix_file_type<const T> : matrix_file_type<T> { };
+
+template<class T>
+matrix_file_header make_file_header(size_t width, size_t height, size_t pitch)
+{
+	matrix_file_header header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, "NMPP", 4);
+	header.version = matrix_file_version;
+	header.type = matrix_file_type<T>::value;
+	header.element_size = sizeof(T);
+	header.byte_order = matrix_file_byte_order;
+	header.width = width;
+	header.height = height;
+	header.pitch = pitch;
+	header.data_offset = matrix_file_data_offset;
+	return header;
+}
+
+// Computes the end of the pixel data, data_offset plus the span from the
+// first to the last element, failing if any step overflows 64 bits.
+inline bool file_data_end(const matrix_file_header& header, uint64_t& end)
+{
+	const uint64_t max = std::numeric_limits<uint64_t>::max();
+	uint64_t elements = 0;
+	if (header.height > 0) {
+		if (header.pitch != 0 && header.height - 1 > max / header.pitch)
+			return false;
+		elements = (header.height - 1) * header.pitch;
+		if (header.width > max - elements)
+			return false;
+		elements += header.width;
+	}
+	if (header.element_size != 0 && elements > max / header.element_size)
+		return false;
+	const uint64_t size = elements * header.element_size;
+	if (size > max - header.data_offset)
+		return false;
+	end = header.data_offset + size;
+	return true;
+}
+
+template<class T>
+void check_file_header(const matrix_file_header& header, const std::string& name)
+{
+	if (std::memcmp(header.magic, "NMPP", 4) != 0)
+		throw std::runtime_error(name + ": not an nmpp matrix file");
+	if (header.version != matrix_file_version)
+		throw std::runtime_error(name + ": unsupported matrix file version");
+	if (header.byte_order != matrix_file_byte_order)
+		throw std::runtime_error(name + ": matrix file has foreign byte order");
+	if (header.element_size != sizeof(T) || (header.type != 0 && matrix_file_type<T>::value != 0 && header.type != matrix_file_type<T>::value))
+		throw std::runtime_error(name + ": matrix file element type mismatch");
+	if (header.width > header.pitch && header.height > 0)
+		throw std::runtime_error(name + ": corrupt matrix file header");
+	if (header.data_offset < sizeof(matrix_file_header) || header.data_offset % alignment_of<T>::value != 0)
+		throw std::runtime_error(name + ": corrupt matrix file header");
+	uint64_t end;
+	if (!file_data_end(header, end) || end > std::numeric_limits<size_t>::max())
+		throw std::runtime_error(name + ": corrupt matrix file header");
+}
+
+} // end namespace detail
+
+} // end namespace nmpp
+
+#endif // NMPP_MATRIX_FILE_HPP
@@ -0,0 +1,440 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_MATRIX_IO_HPP
+#define NMPP_MATRIX_IO_HPP
+
+#include <cassert>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <nmpp/util.hpp>
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/matrix_file.hpp>
+
+namespace nmpp {
+
+namespace detail {
+
+class file_handle
+{
+public:
+	file_handle(const std::string& name, const char* mode)
+		: _file(std::fopen(name.c_str(), mode)), _name(name) {
+		if (!_file)
+			fail();
+	}
+	~file_handle() {
+		if (_file)
+			std::fclose(_file);
+	}
+
+	void read(void* data, size_t bytes) {
+		if (std::fread(data, 1, bytes, _file) != bytes) {
+			if (std::feof(_file))
+				throw std::runtime_error(_name + ": unexpected end of file");
+			fail();
+		}
+	}
+	void write(const void* data, size_t bytes) {
+		if (std::fwrite(data, 1, bytes, _file) != bytes)
+			fail();
+	}
+	void skip(long bytes) {
+		if (bytes != 0 && std::fseek(_file, bytes, SEEK_CUR) != 0)
+			fail();
+	}
+	int get() {
+		return std::getc(_file);
+	}
+	void print(const std::string& text) {
+		write(text.data(), text.size());
+	}
+	void close() {
+		std::FILE* file = _file;
+		_file = 0;
+		if (std::fclose(file) != 0)
+			fail();
+	}
+
+	const std::string& name() const { return _name; }
+
+private:
+	file_handle(const file_handle&);
+	file_handle& operator=(const file_handle&);
+
+	void fail() {
+		throw std::runtime_error(_name + ": " + std::strerror(errno));
+	}
+
+	std::FILE* _file;
+	std::string _name;
+};
+
+template<class T>
+matrix_file_header read_file_header(file_handle& file)
+{
+	matrix_file_header header;
+	file.read(&header, sizeof(header));
+	check_file_header<T>(header, file.name());
+	file.skip(header.data_offset - sizeof(header));
+	return header;
+}
+
+template<class T>
+void write_file_header(file_handle& file, size_t width, size_t height)
+{
+	const matrix_file_header header = make_file_header<T>(width, height, width);
+	file.write(&header, sizeof(header));
+	const char padding[matrix_file_data_offset - sizeof(matrix_file_header)] = { 0 };
+	file.write(padding, sizeof(padding));
+}
+
+template<class InputT, class T>
+void write_file_rows(file_handle& file, const InputT& input, size_t begin, size_t end, std::vector<T>&, dense_storage_tag)
+{
+	const size_t width = input.width();
+	if (input.pitch() == width) {
+		file.write(input.get() + begin * width, (end - begin) * width * sizeof(T));
+		return;
+	}
+	for (size_t y = begin; y < end; ++y)
+		file.write(input.get() + y * input.pitch(), width * sizeof(T));
+}
+
+template<class InputT, class T>
+void write_file_rows(file_handle& file, const InputT& input, size_t begin, size_t end, std::vector<T>& buffer, generic_storage_tag)
+{
+	const size_t width = input.width();
+	buffer.resize(width);
+	for (size_t y = begin; y < end; ++y) {
+		if (width > 0)
+			read_row(input, 0, y, width, &buffer[0]);
+		file.write(&buffer[0], width * sizeof(T));
+	}
+}
+
+template<class InputT, class T>
+void write_file_rows(file_handle& file, const InputT& input, size_t begin, size_t end, std::vector<T>& buffer)
+{
+	typedef typename remove_const<typename InputT::value_type>::type value_type;
+	typedef typename if_c<is_same<value_type, T>::value,
+		typename storage_category<InputT>::type,
+		generic_storage_tag
+	>::type category;
+	write_file_rows(file, input, begin, end, buffer, category());
+}
+
+template<class OutputT>
+void read_file_rows(file_handle& file, const matrix_file_header& header, OutputT& output, size_t count)
+{
+	typedef typename OutputT::value_type value_type;
+	const size_t width = header.width;
+	assert(header.pitch >= header.width || count == 0);
+	const long gap = static_cast<long>((header.pitch - header.width) * sizeof(value_type));
+	if (gap == 0 && output.pitch() == width) {
+		file.read(output.get(), count * width * sizeof(value_type));
+		return;
+	}
+	for (size_t y = 0; y < count; ++y) {
+		file.read(output.get() + y * output.pitch(), width * sizeof(value_type));
+		file.skip(gap);
+	}
+}
+
+} // end namespace detail
+
+template<class InputT>
+void write_matrix(const std::string& path, const InputT& input)
+{
+	typedef typename detail::remove_const<typename InputT::value_type>::type value_type;
+	detail::file_handle file(path, "wb");
+	detail::write_file_header<value_type>(file, input.width(), input.height());
+	std::vector<value_type> buffer;
+	detail::write_file_rows(file, input, 0, input.height(), buffer);
+	file.close();
+}
+
+template<class T, class AllocationT>
+void read_matrix(const std::string& path, auto_matrix<T, AllocationT>& output)
+{
+	detail::file_handle file(path, "rb");
+	const matrix_file_header header = detail::read_file_header<T>(file);
+	output.reset(header.width, header.height);
+	detail::read_file_rows(file, header, output, header.height);
+}
+
+template<class T>
+void read_matrix(const std::string& path, weak_matrix<T>& output)
+{
+	detail::file_handle file(path, "rb");
+	const matrix_file_header header = detail::read_file_header<T>(file);
+	if (header.width != output.width() || header.height != output.height())
+		throw std::runtime_error(path + ": matrix dimensions do not match");
+	detail::read_file_rows(file, header, output, header.height);
+}
+
+template<class T>
+class matrix_reader
+{
+public:
+	typedef T value_type;
+
+	explicit matrix_reader(const std::string& path)
+		: _file(path, "rb"), _header(detail::read_file_header<T>(_file)), _row(0) { }
+
+	size_t width() const { return _header.width; }
+	size_t height() const { return _header.height; }
+	size_t row() const { return _row; }
+	bool done() const { return _row == _header.height; }
+
+	template<class OutputT>
+	size_t read(OutputT& band) {
+		assert(band.width() == width());
+		const size_t count = std::min<size_t>(band.height(), height() - _row);
+		detail::read_file_rows(_file, _header, band, count);
+		_row += count;
+		return count;
+	}
+
+private:
+	detail::file_handle _file;
+	matrix_file_header _header;
+	size_t _row;
+};
+
+template<class T>
+class matrix_writer
+{
+public:
+	typedef T value_type;
+
+	matrix_writer(const std::string& path, size_t width, size_t height)
+		: _file(path, "wb"), _width(width), _height(height), _row(0) {
+		detail::write_file_header<T>(_file, width, height);
+	}
+
+	size_t width() const { return _width; }
+	size_t height() const { return _height; }
+	size_t row() const { return _row; }
+	bool done() const { return _row == _height; }
+
+	template<class InputT>
+	void write(const InputT& band) {
+		assert(band.width() == _width);
+		assert(_row + band.height() <= _height);
+		detail::write_file_rows(_file, band, 0, band.height(), _buffer);
+		_row += band.height();
+	}
+
+	void close() {
+		if (_row != _height)
+			throw std::runtime_error(_file.name() + ": matrix closed before all rows were written");
+		_file.close();
+	}
+
+private:
+	detail::file_handle _file;
+	size_t _width, _height, _row;
+	std::vector<T> _buffer;
+};
+
+namespace detail {
+
+inline size_t read_netpbm_number(file_handle& file)
+{
+	int c = file.get();
+	for (;;) {
+		if (c == '#') {
+			while (c != '\n' && c != EOF)
+				c = file.get();
+		} else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+			c = file.get();
+		} else {
+			break;
+		}
+	}
+	if (c < '0' || c > '9')
+		throw std::runtime_error(file.name() + ": malformed header");
+	size_t value = 0;
+	while (c >= '0' && c <= '9') {
+		value = value * 10 + (c - '0');
+		c = file.get();
+	}
+	return value;
+}
+
+inline std::string read_netpbm_token(file_handle& file)
+{
+	std::string token;
+	int c = file.get();
+	while (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+		c = file.get();
+	while (c != EOF && c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+		token += static_cast<char>(c);
+		c = file.get();
+	}
+	return token;
+}
+
+inline std::string netpbm_size(size_t width, size_t height)
+{
+	char text[64];
+	std::sprintf(text, "%lu %lu\n", static_cast<unsigned long>(width), static_cast<unsigned long>(height));
+	return text;
+}
+
+inline bool little_endian()
+{
+	const uint16_t probe = 1;
+	return *reinterpret_cast<const unsigned char*>(&probe) == 1;
+}
+
+template<class T>
+unsigned int pixel_level(const T& value, unsigned int maxval)
+{
+	const double level = static_cast<double>(value);
+	if (!(level > 0))
+		return 0;
+	if (level >= maxval)
+		return maxval;
+	return static_cast<unsigned int>(level + 0.5);
+}
+
+} // end namespace detail
+
+template<class T, class AllocationT>
+void read_pgm(const std::string& path, auto_matrix<T, AllocationT>& output)
+{
+	detail::file_handle file(path, "rb");
+	if (file.get() != 'P' || file.get() != '5')
+		throw std::runtime_error(path + ": not a binary PGM file");
+	const size_t width = detail::read_netpbm_number(file);
+	const size_t height = detail::read_netpbm_number(file);
+	const size_t maxval = detail::read_netpbm_number(file);
+	if (maxval == 0 || maxval > 65535)
+		throw std::runtime_error(path + ": unsupported PGM maxval");
+	const size_t bytes = maxval < 256 ? 1 : 2;
+	output.reset(width, height);
+	std::vector<unsigned char> row(width * bytes);
+	for (size_t y = 0; y < height; ++y) {
+		if (!row.empty())
+			file.read(&row[0], row.size());
+		T* out = output.get() + y * output.pitch();
+		if (bytes == 1) {
+			for (size_t x = 0; x < width; ++x)
+				out[x] = static_cast<T>(row[x]);
+		} else {
+			for (size_t x = 0; x < width; ++x)
+				out[x] = static_cast<T>(row[2 * x] << 8 | row[2 * x + 1]);
+		}
+	}
+}
+
+template<class InputT>
+void write_pgm(const std::string& path, const InputT& input, unsigned int maxval = 255)
+{
+	typedef typename detail::remove_const<typename InputT::value_type>::type value_type;
+	assert(maxval > 0 && maxval <= 65535);
+	const size_t width = input.width(), height = input.height();
+	const size_t bytes = maxval < 256 ? 1 : 2;
+	detail::file_handle file(path, "wb");
+	char levels[16];
+	std::sprintf(levels, "%u\n", maxval);
+	file.print("P5\n" + detail::netpbm_size(width, height) + levels);
+	std::vector<value_type> buffer(width);
+	std::vector<unsigned char> row(width * bytes);
+	for (size_t y = 0; y < height; ++y) {
+		if (width == 0)
+			continue;
+		detail::read_row(input, 0, y, width, &buffer[0]);
+		for (size_t x = 0; x < width; ++x) {
+			const unsigned int level = detail::pixel_level(buffer[x], maxval);
+			if (bytes == 1) {
+				row[x] = static_cast<unsigned char>(level);
+			} else {
+				row[2 * x] = static_cast<unsigned char>(level >> 8);
+				row[2 * x + 1] = static_cast<unsigned char>(level);
+			}
+		}
+		file.write(&row[0], row.size());
+	}
+	file.close();
+}
+
+template<class T, class AllocationT>
+void read_pfm(const std::string& path, auto_matrix<T, AllocationT>& output)
+{
+	detail::file_handle file(path, "rb");
+	if (detail::read_netpbm_token(file) != "Pf")
+		throw std::runtime_error(path + ": not a greyscale PFM file");
+	const size_t width = detail::read_netpbm_number(file);
+	const size_t height = detail::read_netpbm_number(file);
+	const double scale = std::atof(detail::read_netpbm_token(file).c_str());
+	if (scale == 0)
+		throw std::runtime_error(path + ": malformed header");
+	const bool swap = (scale < 0) != detail::little_endian();
+	output.reset(width, height);
+	std::vector<float> row(width);
+	for (size_t y = height; y-- > 0;) {
+		if (width == 0)
+			continue;
+		file.read(&row[0], width * sizeof(float));
+		if (swap) {
+			for (size_t x = 0; x < width; ++x) {
+				unsigned char* bytes = reinterpret_cast<unsigned char*>(&row[x]);
+				std::reverse(bytes, bytes + sizeof(float));
+			}
+		}
+		T* out = output.get() + y * output.pitch();
+		for (size_t x = 0; x < width; ++x)
+			out[x] = static_cast<T>(row[x]);
+	}
+}
+
+template<class InputT>
+void write_pfm(const std::string& path, const InputT& input)
+{
+	typedef typename detail::remove_const<typename InputT::value_type>::type value_type;
+	const size_t width = input.width(), height = input.height();
+	detail::file_handle file(path, "wb");
+	file.print("Pf\n" + detail::netpbm_size(width, height) + (detail::little_endian() ? "-1.0\n" : "1.0\n"));
+	std::vector<value_type> buffer(width);
+	std::vector<float> row(width);
+	for (size_t y = height; y-- > 0;) {
+		if (width == 0)
+			continue;
+		detail::read_row(input, 0, y, width, &buffer[0]);
+		for (size_t x = 0; x < width; ++x)
+			row[x] = static_cast<float>(buffer[x]);
+		file.write(&row[0], width * sizeof(float));
+	}
+	file.close();
+}
+
+} // end namespace nmpp
+
+#endif // NMPP_MATRIX_IO_HPP
@@ -0,0 +1,290 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef NMPP_MEMORY_POOL_HPP
+#define NMPP_MEMORY_POOL_HPP
+
+#include <cstddef>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include <nmpp/allocation.hpp>
+
+namespace nmpp {
+
+class scoped_arena;
+
+namespace detail {
+
+struct block_header
+{
+	void* raw;
+	size_t size;
+	scoped_arena* arena;
+};
+
+} // end namespace detail
+
+class memory_pool
+{
+public:
+	enum { alignment = 64 };
+	enum { header_size = alignment };
+
+	memory_pool() : _capacity(std::numeric_limits<size_t>::max()), _cached(0) { }
+	~memory_pool() { trim(); }
+
+	static memory_pool& global() {
+		static memory_pool pool;
+		return pool;
+	}
+
+	static size_t size_class(size_t bytes) {
+		if (bytes <= alignment)
+			return alignment;
+		size_t step = alignment;
+		while (step * 8 < bytes)
+			step <<= 1;
+		return (bytes + step - 1) / step * step;
+	}
+
+	void* allocate(size_t bytes) {
+		const size_t size = size_class(bytes);
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			std::vector<void*>& blocks = _free[size];
+			if (!blocks.empty()) {
+				void* block = blocks.back();
+				blocks.pop_back();
+				_cached -= size;
+				return block;
+			}
+		}
+		char* raw = static_cast<char*>(::operator new(size + header_size + alignment));
+		char* block = raw + header_size;
+		block += (alignment - reinterpret_cast<size_t>(block) % alignment) % alignment;
+		header(block)->raw = raw;
+		header(block)->size = size;
+		header(block)->arena = 0;
+		return block;
+	}
+
+	void deallocate(void* block) {
+		if (block == 0)
+			return;
+		const size_t size = header(block)->size;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (_cached + size <= _capacity) {
+				_free[size].push_back(block);
+				_cached += size;
+				return;
+			}
+		}
+		::operator delete(header(block)->raw);
+	}
+
+	void trim() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (std::map<size_t, std::vector<void*> >::iterator i = _free.begin(); i != _free.end(); ++i) {
+			for (size_t j = 0; j < i->second.size(); ++j)
+				::operator delete(header(i->second[j])->raw);
+		}
+		_free.clear();
+		_cached = 0;
+	}
+
+	size_t cached() const {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _cached;
+	}
+	size_t capacity() const {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _capacity;
+	}
+	void capacity(size_t bytes) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_capacity = bytes;
+	}
+
+	static detail::block_header* header(void* block) {
+		return reinterpret_cast<detail::block_header*>(static_cast<char*>(block) - header_size);
+	}
+
+private:
+	memory_pool(const memory_pool&);
+	memory_pool& operator=(const memory_pool&);
+
+	mutable std::mutex _mutex;
+	std::map<size_t, std::vector<void*> > _free;
+	size_t _capacity;
+	size_t _cached;
+};
+
+// Matrices allocated with pool_allocation while an arena is current on
+// this thread share its chunks; they must not outlive the arena.
+class scoped_arena
+{
+public:
+	enum { default_chunk_size = 1 << 20 };
+
+	explicit scoped_arena(size_t chunk_size = default_chunk_size, memory_pool& pool = memory_pool::global())
+		: _pool(pool), _chunk_size(chunk_size), _begin(0), _end(0), _reserved(0), _previous(current())
+	{
+		current() = this;
+	}
+	~scoped_arena() {
+		current() = _previous;
+		for (size_t i = 0; i < _chunks.size(); ++i)
+			_pool.deallocate(_chunks[i]);
+	}
+
+	static scoped_arena*& current() {
+		static thread_local scoped_arena* arena = 0;
+		return arena;
+	}
+
+	// Bytes taken from the pool so far, in whole chunks.
+	size_t reserved() const { return _reserved; }
+
+	void* allocate(size_t bytes) {
+		bytes = (bytes + memory_pool::alignment - 1) / memory_pool::alignment * memory_pool::alignment;
+		if (_begin == 0 || static_cast<size_t>(_end - _begin) < bytes + memory_pool::header_size) {
+			const size_t size = std::max<size_t>(_chunk_size, bytes + memory_pool::header_size);
+			_begin = static_cast<char*>(_pool.allocate(size));
+			_end = _begin + memory_pool::size_class(size);
+			_chunks.push_back(_begin);
+			_reserved += memory_pool::size_class(size);
+		}
+		char* block = _begin + memory_pool::header_size;
+		detail::block_header* header = memory_pool::header(block);
+		header->raw = 0;
+		header->size = bytes;
+		header->arena = this;
+		_begin = block + bytes;
+		return block;
+	}
+
+private:
+	scoped_arena(const scoped_arena&);
+	scoped_arena& operator=(const scoped_arena&);
+
+	memory_pool& _pool;
+	size_t _chunk_size;
+	char* _begin;
+	char* _end;
+	size_t _reserved;
+	scoped_arena* _previous;
+	std::vector<void*> _chunks;
+};
+
+namespace detail {
+
+inline void* arena_allocate(size_t bytes)
+{
+	scoped_arena* arena = scoped_arena::current();
+	return arena ? arena->allocate(bytes) : 0;
+}
+
+// Routes temporary_allocation through scoped_arena. Installed during static
+// initialization, before any threads are started.
+struct arena_hook_installer
+{
+	arena_hook_installer() { arena_allocate_hook() = &arena_allocate; }
+};
+
+static const arena_hook_installer arena_hook_installed;
+
+} // end namespace detail
+
+namespace detail {
+
+template<class T>
+T* construct_pool_block(void* block, size_t size, scoped_arena* arena)
+{
+	T* array = static_cast<T*>(block);
+	size_t i = 0;
+	try {
+		for (; i < size; ++i)
+			new (array + i) T;
+	} catch (...) {
+		destroy(array, i);
+		if (!arena)
+			memory_pool::global().deallocate(block);
+		throw;
+	}
+	return array;
+}
+
+template<class T>
+void release_pool_block(T* array, size_t size)
+{
+	if (array == 0)
+		return;
+	destroy(array, size);
+	if (memory_pool::header(array)->arena == 0)
+		memory_pool::global().deallocate(array);
+}
+
+} // end namespace detail
+
+struct pool_allocation
+{
+	template<class T>
+	static size_t pitch(size_t width) { return aligned_allocation<memory_pool::alignment>::template pitch<T>(width); }
+
+	template<class T>
+	static T* allocate(size_t size) {
+		if (size == 0)
+			return 0;
+		scoped_arena* arena = scoped_arena::current();
+		void* block = arena ? arena->allocate(size * sizeof(T)) : memory_pool::global().allocate(size * sizeof(T));
+		return detail::construct_pool_block<T>(block, size, arena);
+	}
+
+	template<class T>
+	static void deallocate(T* array, size_t size) { detail::release_pool_block(array, size); }
+};
+
+// Like pool_allocation, but always recycles through the global pool, even
+// while a scoped_arena is current. For scratch that is freed and allocated
+// again many times within one arena scope.
+struct recycled_allocation
+{
+	template<class T>
+	static size_t pitch(size_t width) { return pool_allocation::pitch<T>(width); }
+
+	template<class T>
+	static T* allocate(size_t size) {
+		if (size == 0)
+			return 0;
+		return detail::construct_pool_block<T>(memory_pool::global().allocate(size * sizeof(T)), size, 0);
+	}
+
+	template<class T>
+	static void deallocate(T* array, size_t size) { detail::release_pool_block(array, size); }
+};
+
+} // end namespace nmpp
+
+#endif // NMPP_MEMORY_POOL_HPP
@@ -0,0 +1,239 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_MMAP_MATRIX_HPP
+#define NMPP_MMAP_MATRIX_HPP
+
+#include <cassert>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <nmpp/util.hpp>
+#include <nmpp/allocation.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/sub_matrix.hpp>
+#include <nmpp/matrix_file.hpp>
+
+namespace nmpp {
+
+enum mmap_advice {
+	advise_normal,
+	advise_sequential,
+	advise_random,
+	advise_willneed,
+	advise_dontneed
+};
+
+namespace detail {
+
+inline std::runtime_error system_error(const std::string& name)
+{
+	return std::runtime_error(name + ": " + std::strerror(errno));
+}
+
+inline int madvise_flag(mmap_advice advice)
+{
+	switch (advice) {
+	case advise_sequential: return MADV_SEQUENTIAL;
+	case advise_random: return MADV_RANDOM;
+	case advise_willneed: return MADV_WILLNEED;
+	case advise_dontneed: return MADV_DONTNEED;
+	default: return MADV_NORMAL;
+	}
+}
+
+} // end namespace detail
+
+template<class T>
+class mmap_matrix
+{
+public:
+	typedef T value_type;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef T* array_type;
+	typedef const T* const_array_type;
+	typedef mmap_matrix<T> this_type;
+	typedef weak_matrix<T> matrix_ref;
+	typedef weak_matrix<typename detail::add_const<T>::type> matrix_const_ref;
+	typedef detail::dense_storage_tag storage_category;
+
+	enum { writable = !detail::is_const<T>::value };
+
+	explicit mmap_matrix(const std::string& path)
+		: _map(0), _map_size(0), _array(0), _width(0), _height(0), _pitch(0) {
+		const int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+		if (fd < 0)
+			throw detail::system_error(path);
+		struct stat info;
+		if (::fstat(fd, &info) != 0) {
+			const std::runtime_error error = detail::system_error(path);
+			::close(fd);
+			throw error;
+		}
+		if (static_cast<size_t>(info.st_size) < sizeof(matrix_file_header)) {
+			::close(fd);
+			throw std::runtime_error(path + ": not an nmpp matrix file");
+		}
+		map(fd, info.st_size, path);
+		const matrix_file_header& header = *static_cast<const matrix_file_header*>(_map);
+		try {
+			detail::check_file_header<T>(header, path);
+			uint64_t end = 0;
+			detail::file_data_end(header, end);
+			if (end > _map_size)
+				throw std::runtime_error(path + ": matrix file is truncated");
+		} catch (...) {
+			unmap();
+			throw;
+		}
+		_array = reinterpret_cast<array_type>(static_cast<char*>(_map) + header.data_offset);
+		_width = header.width;
+		_height = header.height;
+		_pitch = header.pitch;
+	}
+	mmap_matrix(const std::string& path, size_t width, size_t height)
+		: _map(0), _map_size(0), _array(0), _width(width), _height(height)
+		, _pitch(aligned_allocation<>::pitch<T>(width)) {
+		const matrix_file_header header = detail::make_file_header<T>(_width, _height, _pitch);
+		const size_t size = header.data_offset + _pitch * _height * sizeof(T);
+		const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+		if (fd < 0)
+			throw detail::system_error(path);
+		if (::ftruncate(fd, size) != 0 || ::pwrite(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+			const std::runtime_error error = detail::system_error(path);
+			::close(fd);
+			throw error;
+		}
+		map(fd, size, path);
+		_array = reinterpret_cast<array_type>(static_cast<char*>(_map) + header.data_offset);
+	}
+	~mmap_matrix() { unmap(); }
+
+	reference operator()(size_t x, size_t y) {
+		assert(x < _width);
+		assert(y < _height);
+		return _array[y * _pitch + x];
+	}
+	const_reference operator()(size_t x, size_t y) const {
+		assert(x < _width);
+		assert(y < _height);
+		return _array[y * _pitch + x];
+	}
+	void read_row(size_t x, size_t y, size_t count, typename detail::remove_const<value_type>::type* output) const {
+		assert(x + count <= _width);
+		assert(y < _height);
+		std::copy(_array + y * _pitch + x, _array + y * _pitch + x + count, output);
+	}
+
+	template<class SourceT>
+	this_type& operator=(const SourceT& rhs) {
+		copy_matrix(rhs, *this);
+		return *this;
+	}
+
+	operator weak_matrix<T>() const { return weak_matrix<T>(_array, _width, _height, _pitch); }
+
+	void advise(mmap_advice advice) const {
+		advise(advice, 0, _height);
+	}
+	void advise(mmap_advice advice, size_t y, size_t rows) const {
+		assert(y + rows <= _height);
+		if (rows == 0)
+			return;
+		const size_t page = ::sysconf(_SC_PAGESIZE);
+		const char* base = static_cast<const char*>(_map);
+		const char* begin = reinterpret_cast<const char*>(_array + y * _pitch);
+		const char* end = reinterpret_cast<const char*>(_array + (y + rows - 1) * _pitch + _width);
+		const size_t offset = (begin - base) / page * page;
+		::madvise(const_cast<char*>(base) + offset, end - base - offset, detail::madvise_flag(advice));
+	}
+	void flush() {
+		if (writable && _map && ::msync(_map, _map_size, MS_SYNC) != 0)
+			throw detail::system_error("msync");
+	}
+
+	size_t width() const { return _width; }
+	size_t height() const { return _height; }
+	size_t pitch() const { return _pitch; }
+	array_type get() { return _array; }
+	array_type get() const { return _array; }
+
+private:
+	mmap_matrix(const this_type&);
+	this_type& operator=(const this_type&);
+
+	void map(int fd, size_t size, const std::string& path) {
+		void* map = ::mmap(0, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+		if (map == MAP_FAILED) {
+			const std::runtime_error error = detail::system_error(path);
+			::close(fd);
+			throw error;
+		}
+		::close(fd);
+		_map = map;
+		_map_size = size;
+	}
+	void unmap() {
+		if (_map)
+			::munmap(_map, _map_size);
+		_map = 0;
+	}
+
+	void* _map;
+	size_t _map_size;
+	array_type _array;
+	size_t _width, _height, _pitch;
+};
+
+template<class T>
+detail::region_op<const T>
+offset(const mmap_matrix<T>& matrix, size_t offset_x, size_t offset_y) {
+	return detail::offset_region(detail::dense_view(matrix), offset_x, offset_y);
+}
+
+template<class T>
+detail::region_op<T>
+offset(mmap_matrix<T>& matrix, size_t offset_x, size_t offset_y) {
+	return detail::offset_region(detail::dense_view(matrix), offset_x, offset_y);
+}
+
+template<class T>
+detail::region_op<const T>
+limit(const mmap_matrix<T>& matrix, size_t width, size_t height) {
+	return detail::limit_region(detail::dense_view(matrix), width, height);
+}
+
+template<class T>
+detail::region_op<T>
+limit(mmap_matrix<T>& matrix, size_t width, size_t height) {
+	return detail::limit_region(detail::dense_view(matrix), width, height);
+}
+
+} // end namespace nmpp
+
+#endif // NMPP_MMAP_MATRIX_HPP
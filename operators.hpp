@@ -45,7 +45,7 @@ public:
 	typedef result_type value_type;
 	typedef matrix_binary_op<LeftMatrixT, RightMatrixT, BinaryOpT> this_type;
 	typedef this_type matrix_ref;
-	typedef this_type const_matrix_ref;
+	typedef this_type matrix_const_ref;
 
 	matrix_binary_op(const left_type& lhs, const right_type& rhs, const op_type& op)
 		: _lhs(lhs), _rhs(rhs), _op(op)
@@ -57,11 +57,34 @@ public:
 	}
 
 	value_type operator()(size_t x, size_t y) const { return _op(_lhs(x, y), _rhs(x, y)); }
+	void read_row(size_t x, size_t y, size_t count, value_type* output) const {
+		read_row_impl(x, y, count, output, detail::bool_c<detail::row_cursor<this_type>::value>());
+	}
 
 	size_t width() const { return _lhs.width(); }
 	size_t height() const { return _lhs.height(); }
+	const left_reference& lhs() const { return _lhs; }
+	const right_reference& rhs() const { return _rhs; }
+	const op_type& op() const { return _op; }
 
 private:
+	void read_row_impl(size_t x, size_t y, size_t count, value_type* output, detail::bool_c<true>) const {
+		const detail::row_cursor<this_type> row(*this, y);
+		for (size_t i = 0; i < count; ++i)
+			output[i] = row[x + i];
+	}
+	void read_row_impl(size_t x, size_t y, size_t count, value_type* output, detail::bool_c<false>) const {
+		typename detail::remove_const<typename left_reference::value_type>::type lhs[detail::row_chunk_size];
+		typename detail::remove_const<typename right_reference::value_type>::type rhs[detail::row_chunk_size];
+		for (size_t i = 0; i < count; i += detail::row_chunk_size) {
+			const size_t chunk = std::min<size_t>(detail::row_chunk_size, count - i);
+			detail::read_row(_lhs, x + i, y, chunk, lhs);
+			detail::read_row(_rhs, x + i, y, chunk, rhs);
+			for (size_t j = 0; j < chunk; ++j)
+				output[i + j] = _op(lhs[j], rhs[j]);
+		}
+	}
+
 	left_reference _lhs;
 	right_reference _rhs;
 	BinaryOpT _op;
@@ -90,15 +113,71 @@ public:
 	}
 
 	value_type operator()(size_t x, size_t y) const { return _op(_rhs(x, y)); }
+	void read_row(size_t x, size_t y, size_t count, value_type* output) const {
+		read_row_impl(x, y, count, output, detail::bool_c<detail::row_cursor<this_type>::value>());
+	}
 
 	size_t width() const { return _rhs.width(); }
 	size_t height() const { return _rhs.height(); }
+	const right_reference& rhs() const { return _rhs; }
+	const op_type& op() const { return _op; }
 
 private:
+	void read_row_impl(size_t x, size_t y, size_t count, value_type* output, detail::bool_c<true>) const {
+		const detail::row_cursor<this_type> row(*this, y);
+		for (size_t i = 0; i < count; ++i)
+			output[i] = row[x + i];
+	}
+	void read_row_impl(size_t x, size_t y, size_t count, value_type* output, detail::bool_c<false>) const {
+		typename detail::remove_const<typename right_reference::value_type>::type rhs[detail::row_chunk_size];
+		for (size_t i = 0; i < count; i += detail::row_chunk_size) {
+			const size_t chunk = std::min<size_t>(detail::row_chunk_size, count - i);
+			detail::read_row(_rhs, x + i, y, chunk, rhs);
+			for (size_t j = 0; j < chunk; ++j)
+				output[i + j] = _op(rhs[j]);
+		}
+	}
+
 	right_reference _rhs;
 	UnaryOpT _op;
 };
 
+template<class LeftMatrixT, class RightMatrixT, class BinaryOpT, class CategoryT>
+struct row_cursor<matrix_binary_op<LeftMatrixT, RightMatrixT, BinaryOpT>, CategoryT>
+{
+	typedef typename detail::matrix_ref<LeftMatrixT>::type left_type;
+	typedef typename detail::matrix_ref<RightMatrixT>::type right_type;
+	typedef typename BinaryOpT::result_type value_type;
+	enum { value = row_cursor<left_type>::value && row_cursor<right_type>::value };
+
+	row_cursor(const matrix_binary_op<LeftMatrixT, RightMatrixT, BinaryOpT>& matrix, size_t y)
+		: _lhs(matrix.lhs(), y), _rhs(matrix.rhs(), y), _op(matrix.op()) { }
+
+	value_type operator[](size_t x) const { return _op(_lhs[x], _rhs[x]); }
+
+private:
+	row_cursor<left_type> _lhs;
+	row_cursor<right_type> _rhs;
+	BinaryOpT _op;
+};
+
+template<class MatrixT, class UnaryOpT, class CategoryT>
+struct row_cursor<matrix_unary_op<MatrixT, UnaryOpT>, CategoryT>
+{
+	typedef typename detail::matrix_ref<MatrixT>::type right_type;
+	typedef typename UnaryOpT::result_type value_type;
+	enum { value = row_cursor<right_type>::value };
+
+	row_cursor(const matrix_unary_op<MatrixT, UnaryOpT>& matrix, size_t y)
+		: _rhs(matrix.rhs(), y), _op(matrix.op()) { }
+
+	value_type operator[](size_t x) const { return _op(_rhs[x]); }
+
+private:
+	row_cursor<right_type> _rhs;
+	UnaryOpT _op;
+};
+
 } // end namespace detail
 
 #define MPP_DEF_BINARY_MATRIX_OP(name, op_class) \
@@ -0,0 +1,195 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_PARALLEL_HPP
+#define NMPP_PARALLEL_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <nmpp/util.hpp>
+
+namespace nmpp {
+
+struct sequential_policy { };
+struct parallel_policy { };
+
+const sequential_policy seq = sequential_policy();
+const parallel_policy par = parallel_policy();
+
+class thread_pool
+{
+public:
+	explicit thread_pool(size_t threads = 0)
+		: _tasks(0), _next(0), _busy(0), _generation(0), _stop(false)
+	{
+		resize(threads);
+	}
+	~thread_pool() { stop(); }
+
+	static thread_pool& global() {
+		static thread_pool pool;
+		return pool;
+	}
+
+	size_t size() const { return _workers.size() + 1; }
+
+	void resize(size_t threads) {
+		std::lock_guard<std::mutex> serial(_run_mutex);
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		stop();
+		_stop = false;
+		for (size_t i = 1; i < threads; ++i)
+			_workers.push_back(std::thread(&thread_pool::worker, this));
+	}
+
+	template<class FunctionT>
+	void run(size_t tasks, FunctionT function) {
+		if (tasks == 0)
+			return;
+		if (tasks == 1 || _workers.empty() || inside()) {
+			for (size_t i = 0; i < tasks; ++i)
+				function(i);
+			return;
+		}
+
+		std::lock_guard<std::mutex> serial(_run_mutex);
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_done.wait(lock, [this] { return _busy == 0; });
+			_function = [&function](size_t i) { function(i); };
+			_tasks = tasks;
+			_next = 0;
+			_error = std::exception_ptr();
+			++_generation;
+		}
+		_wake.notify_all();
+
+		inside() = true;
+		work();
+		inside() = false;
+
+		std::exception_ptr error;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_done.wait(lock, [this] { return _busy == 0; });
+			_function = nullptr;
+			error = _error;
+		}
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+private:
+	thread_pool(const thread_pool&);
+	thread_pool& operator=(const thread_pool&);
+
+	static bool& inside() {
+		static thread_local bool flag = false;
+		return flag;
+	}
+
+	void work() {
+		for (size_t i = _next++; i < _tasks; i = _next++) {
+			try {
+				_function(i);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(_mutex);
+				if (!_error)
+					_error = std::current_exception();
+			}
+		}
+	}
+
+	void worker() {
+		inside() = true;
+		std::unique_lock<std::mutex> lock(_mutex);
+		size_t seen = _generation;
+		for (;;) {
+			_wake.wait(lock, [this, seen] { return _stop || _generation != seen; });
+			if (_stop)
+				return;
+			seen = _generation;
+			++_busy;
+			lock.unlock();
+			work();
+			lock.lock();
+			if (--_busy == 0)
+				_done.notify_all();
+		}
+	}
+
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stop = true;
+		}
+		_wake.notify_all();
+		for (size_t i = 0; i < _workers.size(); ++i)
+			_workers[i].join();
+		_workers.clear();
+	}
+
+	std::vector<std::thread> _workers;
+	std::mutex _run_mutex;
+	std::mutex _mutex;
+	std::condition_variable _wake;
+	std::condition_variable _done;
+	std::function<void(size_t)> _function;
+	std::exception_ptr _error;
+	size_t _tasks;
+	std::atomic<size_t> _next;
+	size_t _busy;
+	size_t _generation;
+	bool _stop;
+};
+
+template<class InputT, class OutputT>
+void copy_matrix(const InputT& input, OutputT& output, sequential_policy)
+{
+	copy_matrix(input, output);
+}
+
+template<class InputT, class OutputT>
+void copy_matrix(const InputT& input, OutputT& output, parallel_policy)
+{
+	assert(input.width() <= output.width());
+	assert(input.height() <= output.height());
+	NMPP_INSTRUMENT("copy_matrix(par)", input.width() * input.height(),
+		input.width() * input.height() * sizeof(typename InputT::value_type),
+		input.width() * input.height() * sizeof(typename OutputT::value_type));
+	thread_pool& pool = thread_pool::global();
+	const size_t height = input.height();
+	const size_t bands = std::min(height, pool.size() * 4);
+	pool.run(bands, [&](size_t band) {
+		detail::copy_rows(input, output, height * band / bands, height * (band + 1) / bands);
+	});
+}
+
+} // end namespace nmpp
+
+#endif // NMPP_PARALLEL_HPP
@@ -0,0 +1,145 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_PARALLEL_ALGORITHMS_HPP
+#define NMPP_PARALLEL_ALGORITHMS_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <nmpp/util.hpp>
+#include <nmpp/parallel.hpp>
+#include <nmpp/reduction.hpp>
+#include <nmpp/matmul.hpp>
+
+namespace nmpp {
+
+namespace detail {
+
+template<class PolicyT, class MatrixT>
+struct policy_value;
+template<class MatrixT>
+struct policy_value<sequential_policy, MatrixT> : reduction_value<MatrixT> { };
+template<class MatrixT>
+struct policy_value<parallel_policy, MatrixT> : reduction_value<MatrixT> { };
+
+struct pool_runner
+{
+	template<class FunctionT>
+	void operator()(size_t tasks, const FunctionT& function) const {
+		thread_pool::global().run(tasks, function);
+	}
+};
+
+template<class MatrixT, class ReducerT>
+typename ReducerT::result_type reduce(const MatrixT& matrix, const ReducerT& reducer, sequential_policy)
+{
+	return reduce(matrix, reducer);
+}
+
+template<class MatrixT, class ReducerT>
+typename ReducerT::result_type reduce(const MatrixT& matrix, const ReducerT& reducer, parallel_policy)
+{
+	const size_t blocks = reduction_blocks(matrix);
+	if (blocks == 0)
+		return ReducerT::result(reducer.identity());
+	std::vector<typename ReducerT::state_type> states(blocks);
+	thread_pool::global().run(blocks, [&](size_t block) {
+		states[block] = reduce_block(matrix, reducer, block);
+	});
+	return ReducerT::result(combine_pairwise(&states[0], reducer, 0, blocks));
+}
+
+} // end namespace detail
+
+template<class LeftT, class RightT, class OutputT>
+void matmul(const LeftT& a, const RightT& b, OutputT& output, sequential_policy)
+{
+	matmul(a, b, output);
+}
+
+template<class LeftT, class RightT, class OutputT>
+void matmul(const LeftT& a, const RightT& b, OutputT& output, parallel_policy)
+{
+	detail::gemm(a, b, output, detail::pool_runner());
+}
+
+template<class MatrixT, class PolicyT>
+typename detail::accumulator<typename detail::policy_value<PolicyT, MatrixT>::type>::type
+sum(const MatrixT& matrix, PolicyT policy)
+{
+	return detail::reduce(matrix, detail::sum_reducer<typename detail::reduction_value<MatrixT>::type>(), policy);
+}
+
+template<class MatrixT, class PolicyT>
+typename detail::mean_traits<typename detail::policy_value<PolicyT, MatrixT>::type>::result_type
+mean(const MatrixT& matrix, PolicyT policy)
+{
+	assert(matrix.width() * matrix.height() > 0);
+	return detail::mean_traits<typename detail::reduction_value<MatrixT>::type>::divide(sum(matrix, policy), matrix.width() * matrix.height());
+}
+
+template<class MatrixT, class PolicyT>
+typename detail::policy_value<PolicyT, MatrixT>::type
+min(const MatrixT& matrix, PolicyT policy)
+{
+	return detail::reduce(matrix, detail::extremum_reducer<typename detail::reduction_value<MatrixT>::type, false>(), policy);
+}
+
+template<class MatrixT, class PolicyT>
+typename detail::policy_value<PolicyT, MatrixT>::type
+max(const MatrixT& matrix, PolicyT policy)
+{
+	return detail::reduce(matrix, detail::extremum_reducer<typename detail::reduction_value<MatrixT>::type, true>(), policy);
+}
+
+template<class MatrixT, class PolicyT>
+std::pair<typename detail::policy_value<PolicyT, MatrixT>::type, typename detail::policy_value<PolicyT, MatrixT>::type>
+minmax(const MatrixT& matrix, PolicyT policy)
+{
+	return detail::reduce(matrix, detail::minmax_reducer<typename detail::reduction_value<MatrixT>::type>(), policy);
+}
+
+template<class MatrixT, class PolicyT>
+std::pair<size_t, size_t>
+argmax(const MatrixT& matrix, PolicyT policy)
+{
+	return detail::reduce(matrix, detail::argmax_reducer<typename detail::reduction_value<MatrixT>::type>(), policy);
+}
+
+template<class MatrixT, class PolicyT>
+typename detail::norm_traits<typename detail::policy_value<PolicyT, MatrixT>::type>::result_type
+norm2(const MatrixT& matrix, PolicyT policy)
+{
+	return detail::reduce(matrix, detail::norm2_reducer<typename detail::reduction_value<MatrixT>::type>(), policy);
+}
+
+template<class LeftMatrixT, class RightMatrixT, class PolicyT>
+typename detail::sum_reducer<
+	typename detail::dot_multiplies<typename detail::policy_value<PolicyT, LeftMatrixT>::type>::result_type
+>::result_type
+dot(const LeftMatrixT& lhs, const RightMatrixT& rhs, PolicyT policy)
+{
+	return sum(detail::dot_product(lhs, rhs), policy);
+}
+
+} // end namespace nmpp
+
+#endif // NMPP_PARALLEL_ALGORITHMS_HPP
@@ -0,0 +1,424 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_REDUCTION_HPP
+#define NMPP_REDUCTION_HPP
+
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <algorithm>
+
+#include <nmpp/util.hpp>
+#include <nmpp/operators.hpp>
+
+namespace nmpp {
+
+namespace detail {
+
+template<class T>
+struct norm_traits
+{
+	typedef typename accumulator<T>::type accumulator_type;
+	typedef typename if_c<std::numeric_limits<T>::is_integer, double, accumulator_type>::type result_type;
+	static accumulator_type squared(const T& value) {
+		return static_cast<accumulator_type>(value) * static_cast<accumulator_type>(value);
+	}
+};
+
+template<class T>
+struct norm_traits< std::complex<T> >
+{
+	typedef typename norm_traits<T>::accumulator_type accumulator_type;
+	typedef typename norm_traits<T>::result_type result_type;
+	static accumulator_type squared(const std::complex<T>& value) {
+		return norm_traits<T>::squared(value.real()) + norm_traits<T>::squared(value.imag());
+	}
+};
+
+template<class T>
+struct dot_multiplies
+{
+	typedef T first_argument_type;
+	typedef T second_argument_type;
+	typedef typename accumulator<T>::type result_type;
+	result_type operator()(const T& lhs, const T& rhs) const {
+		return static_cast<result_type>(lhs) * static_cast<result_type>(rhs);
+	}
+};
+
+// Complex dot products conjugate the left operand, so dot(a, a) is the
+// squared norm of a.
+template<class T>
+struct dot_multiplies< std::complex<T> >
+{
+	typedef std::complex<T> first_argument_type;
+	typedef std::complex<T> second_argument_type;
+	typedef typename accumulator< std::complex<T> >::type result_type;
+	result_type operator()(const std::complex<T>& lhs, const std::complex<T>& rhs) const {
+		return std::conj(static_cast<result_type>(lhs)) * static_cast<result_type>(rhs);
+	}
+};
+
+template<class T>
+struct mean_traits
+{
+	typedef typename accumulator<T>::type sum_type;
+	typedef typename if_c<std::numeric_limits<T>::is_integer, double, sum_type>::type result_type;
+	static result_type divide(const sum_type& sum, size_t count) {
+		return static_cast<result_type>(sum) / static_cast<result_type>(count);
+	}
+};
+
+template<class T>
+struct mean_traits< std::complex<T> >
+{
+	typedef typename accumulator< std::complex<T> >::type sum_type;
+	typedef std::complex<typename mean_traits<T>::result_type> result_type;
+	static result_type divide(const sum_type& sum, size_t count) {
+		return result_type(mean_traits<T>::divide(sum.real(), count), mean_traits<T>::divide(sum.imag(), count));
+	}
+};
+
+template<class T>
+struct sum_reducer
+{
+	typedef typename accumulator<T>::type state_type;
+	typedef state_type result_type;
+
+	state_type identity() const { return state_type(0); }
+	void chunk(state_type& state, const T* data, size_t, size_t, size_t count) const {
+		state_type s0 = state_type(0), s1 = state_type(0), s2 = state_type(0), s3 = state_type(0);
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			s0 += static_cast<state_type>(data[i]);
+			s1 += static_cast<state_type>(data[i + 1]);
+			s2 += static_cast<state_type>(data[i + 2]);
+			s3 += static_cast<state_type>(data[i + 3]);
+		}
+		for (; i < count; ++i)
+			s0 += static_cast<state_type>(data[i]);
+		state += (s0 + s1) + (s2 + s3);
+	}
+	state_type combine(const state_type& lhs, const state_type& rhs) const { return lhs + rhs; }
+	static result_type result(const state_type& state) { return state; }
+};
+
+template<class T>
+struct norm2_reducer
+{
+	typedef typename norm_traits<T>::accumulator_type state_type;
+	typedef typename norm_traits<T>::result_type result_type;
+
+	state_type identity() const { return state_type(0); }
+	void chunk(state_type& state, const T* data, size_t, size_t, size_t count) const {
+		state_type s0 = state_type(0), s1 = state_type(0), s2 = state_type(0), s3 = state_type(0);
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			s0 += norm_traits<T>::squared(data[i]);
+			s1 += norm_traits<T>::squared(data[i + 1]);
+			s2 += norm_traits<T>::squared(data[i + 2]);
+			s3 += norm_traits<T>::squared(data[i + 3]);
+		}
+		for (; i < count; ++i)
+			s0 += norm_traits<T>::squared(data[i]);
+		state += (s0 + s1) + (s2 + s3);
+	}
+	state_type combine(const state_type& lhs, const state_type& rhs) const { return lhs + rhs; }
+	static result_type result(const state_type& state) { return std::sqrt(static_cast<result_type>(state)); }
+};
+
+template<class T>
+struct extremum_state
+{
+	T value;
+	size_t x, y;
+	bool found;
+};
+
+template<class T, bool Max>
+struct extremum_reducer
+{
+	typedef extremum_state<T> state_type;
+	typedef T result_type;
+
+	static bool better(const T& a, const T& b) { return Max ? b < a : a < b; }
+
+	state_type identity() const {
+		state_type state;
+		state.value = T();
+		state.x = state.y = 0;
+		state.found = false;
+		return state;
+	}
+	void chunk(state_type& state, const T* data, size_t x, size_t y, size_t count) const {
+		if (count == 0)
+			return;
+		if (!state.found) {
+			state.value = data[0];
+			state.x = x;
+			state.y = y;
+			state.found = true;
+		}
+		size_t index = count;
+		T best = state.value;
+		for (size_t i = 0; i < count; ++i) {
+			if (better(data[i], best)) {
+				best = data[i];
+				index = i;
+			}
+		}
+		if (index != count) {
+			state.value = best;
+			state.x = x + index;
+			state.y = y;
+		}
+	}
+	state_type combine(const state_type& lhs, const state_type& rhs) const {
+		if (!lhs.found || (rhs.found && better(rhs.value, lhs.value)))
+			return rhs;
+		return lhs;
+	}
+	static result_type result(const state_type& state) {
+		assert(state.found);
+		return state.value;
+	}
+};
+
+template<class T>
+struct argmax_reducer : extremum_reducer<T, true>
+{
+	typedef std::pair<size_t, size_t> result_type;
+	static result_type result(const extremum_state<T>& state) {
+		assert(state.found);
+		return result_type(state.x, state.y);
+	}
+};
+
+template<class T>
+struct minmax_state
+{
+	T min, max;
+	bool found;
+};
+
+template<class T>
+struct minmax_reducer
+{
+	typedef minmax_state<T> state_type;
+	typedef std::pair<T, T> result_type;
+
+	state_type identity() const {
+		state_type state;
+		state.min = state.max = T();
+		state.found = false;
+		return state;
+	}
+	void chunk(state_type& state, const T* data, size_t, size_t, size_t count) const {
+		if (count == 0)
+			return;
+		T lo = state.found ? state.min : data[0];
+		T hi = state.found ? state.max : data[0];
+		for (size_t i = 0; i < count; ++i) {
+			lo = data[i] < lo ? data[i] : lo;
+			hi = hi < data[i] ? data[i] : hi;
+		}
+		state.min = lo;
+		state.max = hi;
+		state.found = true;
+	}
+	state_type combine(const state_type& lhs, const state_type& rhs) const {
+		if (!lhs.found)
+			return rhs;
+		if (!rhs.found)
+			return lhs;
+		state_type state = lhs;
+		state.min = rhs.min < lhs.min ? rhs.min : lhs.min;
+		state.max = lhs.max < rhs.max ? rhs.max : lhs.max;
+		return state;
+	}
+	static result_type result(const state_type& state) {
+		assert(state.found);
+		return result_type(state.min, state.max);
+	}
+};
+
+template<class MatrixT>
+struct reduction_value { typedef typename remove_const<typename MatrixT::value_type>::type type; };
+
+enum { reduction_block_size = 1 << 14 };
+
+template<class MatrixT>
+size_t reduction_block_rows(const MatrixT& matrix)
+{
+	return std::max<size_t>(1, reduction_block_size / std::max<size_t>(1, matrix.width()));
+}
+
+template<class MatrixT>
+size_t reduction_blocks(const MatrixT& matrix)
+{
+	if (matrix.width() == 0)
+		return 0;
+	const size_t rows = reduction_block_rows(matrix);
+	return (matrix.height() + rows - 1) / rows;
+}
+
+template<class MatrixT, class ReducerT>
+void reduce_rows(const MatrixT& matrix, size_t begin, size_t end, const ReducerT& reducer,
+		typename ReducerT::state_type& state, dense_storage_tag)
+{
+	for (size_t y = begin; y < end; ++y)
+		reducer.chunk(state, matrix.get() + y * matrix.pitch(), 0, y, matrix.width());
+}
+
+template<class MatrixT, class ReducerT>
+void reduce_rows(const MatrixT& matrix, size_t begin, size_t end, const ReducerT& reducer,
+		typename ReducerT::state_type& state, generic_storage_tag)
+{
+	typename reduction_value<MatrixT>::type buffer[row_chunk_size];
+	const size_t width = matrix.width();
+	for (size_t y = begin; y < end; ++y) {
+		for (size_t x = 0; x < width; x += row_chunk_size) {
+			const size_t count = std::min<size_t>(row_chunk_size, width - x);
+			read_row(matrix, x, y, count, buffer);
+			reducer.chunk(state, buffer, x, y, count);
+		}
+	}
+}
+
+template<class MatrixT, class ReducerT>
+typename ReducerT::state_type reduce_block(const MatrixT& matrix, const ReducerT& reducer, size_t block)
+{
+	const size_t rows = reduction_block_rows(matrix);
+	typename ReducerT::state_type state = reducer.identity();
+	reduce_rows(matrix, block * rows, std::min(matrix.height(), (block + 1) * rows), reducer, state,
+		typename storage_category<MatrixT>::type());
+	return state;
+}
+
+template<class MatrixT, class ReducerT>
+typename ReducerT::state_type reduce_pairwise(const MatrixT& matrix, const ReducerT& reducer, size_t first, size_t last)
+{
+	if (last - first == 1)
+		return reduce_block(matrix, reducer, first);
+	const size_t middle = first + (last - first) / 2;
+	return reducer.combine(reduce_pairwise(matrix, reducer, first, middle), reduce_pairwise(matrix, reducer, middle, last));
+}
+
+template<class StateT, class ReducerT>
+StateT combine_pairwise(const StateT* states, const ReducerT& reducer, size_t first, size_t last)
+{
+	if (last - first == 1)
+		return states[first];
+	const size_t middle = first + (last - first) / 2;
+	return reducer.combine(combine_pairwise(states, reducer, first, middle), combine_pairwise(states, reducer, middle, last));
+}
+
+template<class MatrixT, class ReducerT>
+typename ReducerT::result_type reduce(const MatrixT& matrix, const ReducerT& reducer)
+{
+	const size_t blocks = reduction_blocks(matrix);
+	if (blocks == 0)
+		return ReducerT::result(reducer.identity());
+	return ReducerT::result(reduce_pairwise(matrix, reducer, 0, blocks));
+}
+
+template<class LeftMatrixT, class RightMatrixT>
+matrix_binary_op<LeftMatrixT, RightMatrixT, dot_multiplies<typename reduction_value<LeftMatrixT>::type> >
+dot_product(const LeftMatrixT& lhs, const RightMatrixT& rhs)
+{
+	assert(lhs.width() == rhs.width());
+	assert(lhs.height() == rhs.height());
+	typedef dot_multiplies<typename reduction_value<LeftMatrixT>::type> op_type;
+	return matrix_binary_op<LeftMatrixT, RightMatrixT, op_type>(lhs, rhs, op_type());
+}
+
+} // end namespace detail
+
+template<class MatrixT>
+typename detail::sum_reducer<typename detail::reduction_value<MatrixT>::type>::result_type
+sum(const MatrixT& matrix)
+{
+	return detail::reduce(matrix, detail::sum_reducer<typename detail::reduction_value<MatrixT>::type>());
+}
+
+/**
+ * Mean of all elements; integer matrices give a double (or complex<double>)
+ * mean rather than a truncated one.
+ */
+template<class MatrixT>
+typename detail::mean_traits<typename detail::reduction_value<MatrixT>::type>::result_type
+mean(const MatrixT& matrix)
+{
+	assert(matrix.width() * matrix.height() > 0);
+	return detail::mean_traits<typename detail::reduction_value<MatrixT>::type>::divide(sum(matrix), matrix.width() * matrix.height());
+}
+
+template<class MatrixT>
+typename detail::reduction_value<MatrixT>::type
+min(const MatrixT& matrix)
+{
+	return detail::reduce(matrix, detail::extremum_reducer<typename detail::reduction_value<MatrixT>::type, false>());
+}
+
+template<class MatrixT>
+typename detail::reduction_value<MatrixT>::type
+max(const MatrixT& matrix)
+{
+	return detail::reduce(matrix, detail::extremum_reducer<typename detail::reduction_value<MatrixT>::type, true>());
+}
+
+template<class MatrixT>
+std::pair<typename detail::reduction_value<MatrixT>::type, typename detail::reduction_value<MatrixT>::type>
+minmax(const MatrixT& matrix)
+{
+	return detail::reduce(matrix, detail::minmax_reducer<typename detail::reduction_value<MatrixT>::type>());
+}
+
+template<class MatrixT>
+std::pair<size_t, size_t>
+argmax(const MatrixT& matrix)
+{
+	return detail::reduce(matrix, detail::argmax_reducer<typename detail::reduction_value<MatrixT>::type>());
+}
+
+template<class MatrixT>
+typename detail::norm2_reducer<typename detail::reduction_value<MatrixT>::type>::result_type
+norm2(const MatrixT& matrix)
+{
+	return detail::reduce(matrix, detail::norm2_reducer<typename detail::reduction_value<MatrixT>::type>());
+}
+
+/**
+ * Sum of elementwise products; complex matrices use conj(lhs) * rhs.
+ */
+template<class LeftMatrixT, class RightMatrixT>
+typename detail::sum_reducer<
+	typename detail::dot_multiplies<typename detail::reduction_value<LeftMatrixT>::type>::result_type
+>::result_type
+dot(const LeftMatrixT& lhs, const RightMatrixT& rhs)
+{
+	return sum(detail::dot_product(lhs, rhs));
+}
+
+} // end namespace nmpp
+
+#endif // NMPP_REDUCTION_HPP
@@ -0,0 +1,91 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_STATIC_MATRIX_HPP
+#define NMPP_STATIC_MATRIX_HPP
+
+#include <cassert>
+#include <algorithm>
+#include <cstddef>
+
+#include <nmpp/util.hpp>
+#include <nmpp/weak_matrix.hpp>
+
+namespace nmpp {
+
+template<class T, size_t W, size_t H>
+class static_matrix
+{
+public:
+	typedef T value_type;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef T* array_type;
+	typedef const T* const_array_type;
+	typedef static_matrix<T, W, H> this_type;
+	typedef weak_matrix<T> matrix_ref;
+	typedef weak_matrix<typename detail::add_const<T>::type> matrix_const_ref;
+	typedef detail::dense_storage_tag storage_category;
+
+	enum { static_width = W, static_height = H };
+
+	static_matrix() { }
+	explicit static_matrix(value_type value) {
+		std::fill(_array, _array + W * H, value);
+	}
+	explicit static_matrix(const value_type* values) {
+		std::copy(values, values + W * H, _array);
+	}
+
+	reference operator()(size_t x, size_t y) {
+		assert(x < W);
+		assert(y < H);
+		return _array[y * W + x];
+	}
+	const_reference operator()(size_t x, size_t y) const {
+		assert(x < W);
+		assert(y < H);
+		return _array[y * W + x];
+	}
+	void read_row(size_t x, size_t y, size_t count, typename detail::remove_const<value_type>::type* output) const {
+		assert(x + count <= W);
+		assert(y < H);
+		std::copy(_array + y * W + x, _array + y * W + x + count, output);
+	}
+
+	template<class SourceT>
+	this_type& operator=(const SourceT& rhs) {
+		copy_matrix(rhs, *this);
+		return *this;
+	}
+
+	operator weak_matrix<T>() const { return weak_matrix<T>(const_cast<array_type>(_array), W, H, W); }
+
+	static size_t width() { return W; }
+	static size_t height() { return H; }
+	static size_t pitch() { return W; }
+	array_type get() { return _array; }
+	const_array_type get() const { return _array; }
+
+private:
+	T _array[W * H];
+};
+
+} // end namespace nmpp
+
+#endif // NMPP_STATIC_MATRIX_HPP
@@ -23,6 +23,8 @@
 #include <cstddef>
 
 #include <nmpp/util.hpp>
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
 
 namespace nmpp {
 
@@ -53,6 +55,9 @@ public:
 
 	reference operator()(size_t x, size_t y) { return _matrix(x + _offset_x, y + _offset_y); }
 	const_reference operator()(size_t x, size_t y) const { return _matrix(x + _offset_x, y + _offset_y); }
+	void read_row(size_t x, size_t y, size_t count, typename detail::remove_const<value_type>::type* output) const {
+		detail::read_row(_matrix, x + _offset_x, y + _offset_y, count, output);
+	}
 
 	template<class SourceT>
 	this_type& operator=(const SourceT& rhs) {
@@ -97,6 +102,14 @@ public:
 
 	reference operator()(size_t x, size_t y) { return _matrix(x * _step_x, y * _step_y); }
 	const_reference operator()(size_t x, size_t y) const { return _matrix(x * _step_x, y * _step_y); }
+	void read_row(size_t x, size_t y, size_t count, typename detail::remove_const<value_type>::type* output) const {
+		if (_step_x == 1) {
+			detail::read_row(_matrix, x, y * _step_y, count, output);
+			return;
+		}
+		for (size_t i = 0; i < count; ++i)
+			output[i] = _matrix((x + i) * _step_x, y * _step_y);
+	}
 
 	template<class SourceT>
 	this_type& operator=(const SourceT& rhs) {
@@ -152,6 +165,11 @@ public:
 		assert(y < _height);
 		return _matrix(x, y);
 	}
+	void read_row(size_t x, size_t y, size_t count, typename detail::remove_const<value_type>::type* output) const {
+		assert(x + count <= _width);
+		assert(y < _height);
+		detail::read_row(_matrix, x, y, count, output);
+	}
 
 	template<class SourceT>
 	this_type& operator=(const SourceT& rhs) {
@@ -169,6 +187,77 @@ private:
 	const size_t _width, _height;
 };
 
+/* A pitched window into dense storage, as returned by offset() and limit()
+ * on dense matrices. Unlike weak_matrix, assignment from any matrix,
+ * including another region, copies elements instead of rebinding. */
+template<class T>
+class region_op : public weak_matrix<T>
+{
+	typedef weak_matrix<T> view_type;
+
+public:
+	typedef typename view_type::array_type array_type;
+	typedef region_op<T> this_type;
+
+	region_op(const view_type& matrix, size_t offset_x, size_t offset_y, size_t width, size_t height)
+		: view_type(origin(matrix) + offset_y * matrix.pitch() + offset_x, width, height, matrix.pitch())
+		, _matrix(matrix), _offset_x(offset_x), _offset_y(offset_y)
+	{
+		assert(offset_x + width <= matrix.width());
+		assert(offset_y + height <= matrix.height());
+	}
+	region_op(const this_type& other)
+		: view_type(other), _matrix(other._matrix), _offset_x(other._offset_x), _offset_y(other._offset_y) { }
+
+	template<class SourceT>
+	this_type& operator=(const SourceT& rhs) {
+		copy_matrix(rhs, *this);
+		return *this;
+	}
+
+	this_type& operator=(const this_type& rhs) {
+		copy_matrix(rhs, *this);
+		return *this;
+	}
+
+	size_t offset_x() const { return _offset_x; }
+	size_t offset_y() const { return _offset_y; }
+	view_type matrix() const { return _matrix; }
+
+private:
+	static array_type origin(view_type matrix) { return matrix.get(); }
+
+	const view_type _matrix;
+	const size_t _offset_x, _offset_y;
+};
+
+template<class T>
+region_op<T> offset_region(const weak_matrix<T>& matrix, size_t offset_x, size_t offset_y)
+{
+	assert(offset_x <= matrix.width());
+	assert(offset_y <= matrix.height());
+	return region_op<T>(matrix, offset_x, offset_y, matrix.width() - offset_x, matrix.height() - offset_y);
+}
+
+template<class T>
+region_op<T> limit_region(const weak_matrix<T>& matrix, size_t width, size_t height)
+{
+	return region_op<T>(matrix, 0, 0, width, height);
+}
+
+template<class MatrixT>
+weak_matrix<typename MatrixT::value_type> dense_view(MatrixT& matrix)
+{
+	return weak_matrix<typename MatrixT::value_type>(matrix.get(), matrix.width(), matrix.height(), matrix.pitch());
+}
+
+template<class MatrixT>
+weak_matrix<const typename remove_const<typename MatrixT::value_type>::type> dense_view(const MatrixT& matrix)
+{
+	return weak_matrix<const typename remove_const<typename MatrixT::value_type>::type>(
+		matrix.get(), matrix.width(), matrix.height(), matrix.pitch());
+}
+
 } // end namespace detail
 
 template<class MatrixT>
@@ -177,6 +266,58 @@ offset(MatrixT& matrix, size_t offset_x, size_t offset_y) {
 	return detail::offset_op<MatrixT>(matrix, offset_x, offset_y);
 }
 
+template<class T>
+detail::region_op<T>
+offset(weak_matrix<T>& matrix, size_t offset_x, size_t offset_y) {
+	return detail::offset_region(detail::dense_view(matrix), offset_x, offset_y);
+}
+
+template<class T>
+detail::region_op<const T>
+offset(const weak_matrix<T>& matrix, size_t offset_x, size_t offset_y) {
+	return detail::offset_region(detail::dense_view(matrix), offset_x, offset_y);
+}
+
+template<class T>
+detail::region_op<T>
+offset(detail::region_op<T>& matrix, size_t offset_x, size_t offset_y) {
+	return detail::offset_region(detail::dense_view(matrix), offset_x, offset_y);
+}
+
+template<class T>
+detail::region_op<const T>
+offset(const detail::region_op<T>& matrix, size_t offset_x, size_t offset_y) {
+	return detail::offset_region(detail::dense_view(matrix), offset_x, offset_y);
+}
+
+template<class T, class AllocationT>
+detail::region_op<T>
+offset(auto_matrix<T, AllocationT>& matrix, size_t offset_x, size_t offset_y) {
+	return detail::offset_region(detail::dense_view(matrix), offset_x, offset_y);
+}
+
+template<class T, class AllocationT>
+detail::region_op<const T>
+offset(const auto_matrix<T, AllocationT>& matrix, size_t offset_x, size_t offset_y) {
+	return detail::offset_region(detail::dense_view(matrix), offset_x, offset_y);
+}
+
+// Temporary views, such as the result of a nested offset() or limit(), stay
+// writable.
+#if __cplusplus >= 201103L
+template<class T>
+detail::region_op<T>
+offset(weak_matrix<T>&& matrix, size_t offset_x, size_t offset_y) {
+	return offset(matrix, offset_x, offset_y);
+}
+
+template<class T>
+detail::region_op<T>
+offset(detail::region_op<T>&& matrix, size_t offset_x, size_t offset_y) {
+	return offset(matrix, offset_x, offset_y);
+}
+#endif
+
 template<class MatrixT>
 detail::step_op<MatrixT>
 step(MatrixT& matrix, size_t step_x, size_t step_y) {
@@ -189,6 +330,58 @@ limit(MatrixT& matrix, size_t width, size_t height) {
 	return detail::limit_op<MatrixT>(matrix, width, height);
 }
 
+template<class T>
+detail::region_op<T>
+limit(weak_matrix<T>& matrix, size_t width, size_t height) {
+	return detail::limit_region(detail::dense_view(matrix), width, height);
+}
+
+template<class T>
+detail::region_op<const T>
+limit(const weak_matrix<T>& matrix, size_t width, size_t height) {
+	return detail::limit_region(detail::dense_view(matrix), width, height);
+}
+
+template<class T>
+detail::region_op<T>
+limit(detail::region_op<T>& matrix, size_t width, size_t height) {
+	return detail::limit_region(detail::dense_view(matrix), width, height);
+}
+
+template<class T>
+detail::region_op<const T>
+limit(const detail::region_op<T>& matrix, size_t width, size_t height) {
+	return detail::limit_region(detail::dense_view(matrix), width, height);
+}
+
+template<class T, class AllocationT>
+detail::region_op<T>
+limit(auto_matrix<T, AllocationT>& matrix, size_t width, size_t height) {
+	return detail::limit_region(detail::dense_view(matrix), width, height);
+}
+
+template<class T, class AllocationT>
+detail::region_op<const T>
+limit(const auto_matrix<T, AllocationT>& matrix, size_t width, size_t height) {
+	return detail::limit_region(detail::dense_view(matrix), width, height);
+}
+
+// Temporary views, such as the result of a nested offset() or limit(), stay
+// writable.
+#if __cplusplus >= 201103L
+template<class T>
+detail::region_op<T>
+limit(weak_matrix<T>&& matrix, size_t width, size_t height) {
+	return limit(matrix, width, height);
+}
+
+template<class T>
+detail::region_op<T>
+limit(detail::region_op<T>&& matrix, size_t width, size_t height) {
+	return limit(matrix, width, height);
+}
+#endif
+
 } // end namespace nmpp
 
 #endif // NMPP_SUB_MATRIX_HPP
@@ -20,6 +20,7 @@
 #include <boost/test/test_case_template.hpp>
 #include <boost/mpl/list.hpp>
 #include <complex>
+#include <vector>
 
 #include <nmpp/auto_matrix.hpp>
 
@@ -112,6 +113,80 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( SwapTwoEmpty, T, test_types )
 	BOOST_CHECK_EQUAL( m2.get(), ((T*)0) );
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( CopyCtor, T, test_types )
+{
+	auto_matrix<T> m1(7, 3, T(5));
+	m1(6, 2) = T(9);
+	auto_matrix<T> m2(m1);
+	BOOST_CHECK_EQUAL( m2.width(), 7 );
+	BOOST_CHECK_EQUAL( m2.height(), 3 );
+	BOOST_CHECK_NE( m2.get(), m1.get() );
+	BOOST_CHECK_EQUAL( m2(0, 0), T(5) );
+	BOOST_CHECK_EQUAL( m2(6, 2), T(9) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( CopyCtorEmpty, T, test_types )
+{
+	auto_matrix<T> m1;
+	auto_matrix<T> m2(m1);
+	BOOST_CHECK_EQUAL( m2.width(), 0 );
+	BOOST_CHECK_EQUAL( m2.height(), 0 );
+	BOOST_CHECK_EQUAL( m2.get(), ((T*)0) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( CopyCtorStrided, T, test_types )
+{
+	T* a = new T[4*2];
+	for (int i = 0; i < 8; ++i)
+		a[i] = T(i);
+	auto_matrix<T> m1(a, 3, 2, 4);
+	auto_matrix<T> m2(m1);
+	BOOST_CHECK_EQUAL( m2.pitch(), 3 );
+	BOOST_CHECK_EQUAL( m2(2, 0), T(2) );
+	BOOST_CHECK_EQUAL( m2(0, 1), T(4) );
+	BOOST_CHECK_EQUAL( m2(2, 1), T(6) );
+}
+
+#if __cplusplus >= 201103L
+BOOST_AUTO_TEST_CASE_TEMPLATE( MoveCtor, T, test_types )
+{
+	auto_matrix<T> m1(17, 5, T(3));
+	T* p = m1.get();
+	auto_matrix<T> m2(std::move(m1));
+	BOOST_CHECK_EQUAL( m2.get(), p );
+	BOOST_CHECK_EQUAL( m2.width(), 17 );
+	BOOST_CHECK_EQUAL( m2.height(), 5 );
+	BOOST_CHECK_EQUAL( m2(16, 4), T(3) );
+	BOOST_CHECK_EQUAL( m1.get(), ((T*)0) );
+	BOOST_CHECK_EQUAL( m1.width(), 0 );
+	BOOST_CHECK_EQUAL( m1.height(), 0 );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( MoveAssign, T, test_types )
+{
+	auto_matrix<T> m1(17, 5);
+	auto_matrix<T> m2(3, 3);
+	T* p = m1.get();
+	m2 = std::move(m1);
+	BOOST_CHECK_EQUAL( m2.get(), p );
+	BOOST_CHECK_EQUAL( m2.width(), 17 );
+	BOOST_CHECK_EQUAL( m1.get(), ((T*)0) );
+	BOOST_CHECK_EQUAL( m1.width(), 0 );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( VectorReallocMoves, T, test_types )
+{
+	BOOST_CHECK( std::is_nothrow_move_constructible< auto_matrix<T> >::value );
+	std::vector< auto_matrix<T> > v;
+	v.push_back(auto_matrix<T>(4, 4, T(1)));
+	T* p = v[0].get();
+	for (int i = 0; i < 16; ++i)
+		v.push_back(auto_matrix<T>(4, 4));
+	BOOST_CHECK_EQUAL( v[0].get(), p );
+	BOOST_CHECK_EQUAL( v[0](3, 3), T(1) );
+}
+#endif
+
 BOOST_AUTO_TEST_CASE_TEMPLATE( ResetToArray, T, test_types )
 {
 	auto_matrix<T> m(13, 11);
@@ -210,4 +285,43 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( WriteConstReadValue, T, test_types )
 	BOOST_CHECK_EQUAL( ref(0, 0), T(23) );
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( AlignedRows, T, test_types )
+{
+	auto_matrix<T, aligned_allocation<64> > m(13, 7, T(5));
+	BOOST_CHECK_EQUAL( m.width(), 13 );
+	BOOST_CHECK_EQUAL( m.height(), 7 );
+	BOOST_CHECK_GE( m.pitch(), m.width() );
+	BOOST_CHECK_EQUAL( m.pitch() * sizeof(T) % 64, 0 );
+	for (size_t y = 0; y < m.height(); ++y)
+		BOOST_CHECK_EQUAL( reinterpret_cast<size_t>(&m(0, y)) % 64, 0 );
+	m(12, 3) = T(9);
+	BOOST_CHECK_EQUAL( m(12, 3), T(9) );
+	BOOST_CHECK_EQUAL( m(0, 4), T(5) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( AlignedPitchAvoidsAliasing, T, test_types )
+{
+	auto_matrix<T, aligned_allocation<64> > m(4096 / sizeof(T), 2);
+	BOOST_CHECK_GT( m.pitch(), m.width() );
+	BOOST_CHECK_NE( m.pitch() * sizeof(T) % 4096, 0 );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( AlignedAssign, T, test_types )
+{
+	auto_matrix<T, aligned_allocation<64> > m1(3, 2);
+	for (size_t y = 0; y < m1.height(); ++y)
+		for (size_t x = 0; x < m1.width(); ++x)
+			m1(x, y) = T(int(y * 3 + x));
+	auto_matrix<T, aligned_allocation<64> > m2;
+	m2 = m1;
+	BOOST_CHECK_EQUAL( m2.width(), 3 );
+	BOOST_CHECK_EQUAL( m2.height(), 2 );
+	BOOST_CHECK_NE( m1.get(), m2.get() );
+	BOOST_CHECK_EQUAL( m2(2, 1), T(5) );
+	auto_matrix<T> m3(3, 2);
+	m3 = m1;
+	BOOST_CHECK_EQUAL( m3.pitch(), 3 );
+	BOOST_CHECK_EQUAL( m3(1, 1), T(4) );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
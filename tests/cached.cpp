@@ -0,0 +1,117 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <complex>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/operators.hpp>
+#include <nmpp/convolution.hpp>
+#include <nmpp/parallel.hpp>
+#include <nmpp/cached.hpp>
+
+#include "test_helpers.hpp"
+
+using namespace nmpp;
+
+typedef boost::mpl::list< double, int, std::complex<float> > test_types;
+
+namespace {
+
+template<class T>
+struct counting_negate
+{
+	typedef T argument_type;
+	typedef T result_type;
+	T operator()(const T& value) const { ++calls; return -value; }
+	static size_t calls;
+};
+template<class T>
+size_t counting_negate<T>::calls = 0;
+
+template<class T>
+detail::matrix_unary_op< auto_matrix<T>, counting_negate<T> > counted(const auto_matrix<T>& m)
+{
+	return detail::matrix_unary_op< auto_matrix<T>, counting_negate<T> >(m, counting_negate<T>());
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( Cached )
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( EvaluatesOnce, T, test_types )
+{
+	auto_matrix<T> m(300, 40);
+	fill_pattern(m, 7, 3, 11, 0);
+	auto_matrix<T> result(300, 40);
+	counting_negate<T>::calls = 0;
+	copy_matrix(mmul(counted(m), counted(m)), result);
+	BOOST_CHECK_EQUAL( counting_negate<T>::calls, 2 * 300 * 40 );
+
+	counting_negate<T>::calls = 0;
+	const detail::cached_op< detail::matrix_unary_op< auto_matrix<T>, counting_negate<T> > > c = cached(counted(m));
+	copy_matrix(mmul(c, c), result);
+	BOOST_CHECK_EQUAL( counting_negate<T>::calls, 300 * 40 );
+	copy_matrix(mplus(c, c), result);
+	BOOST_CHECK_EQUAL( counting_negate<T>::calls, 300 * 40 );
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			BOOST_CHECK_EQUAL( result(x, y), -m(x, y) - m(x, y) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( TileByTile, T, test_types )
+{
+	auto_matrix<T> m(600, 50);
+	fill_pattern(m, 7, 3, 11, 0);
+	counting_negate<T>::calls = 0;
+	const detail::cached_op< detail::matrix_unary_op< auto_matrix<T>, counting_negate<T> > > c = cached(counted(m));
+	BOOST_CHECK_EQUAL( c(599, 49), -m(599, 49) );
+	BOOST_CHECK_EQUAL( counting_negate<T>::calls, (600 - 512) * (50 - 48) );
+	BOOST_CHECK_EQUAL( c(0, 0), -m(0, 0) );
+	BOOST_CHECK_EQUAL( counting_negate<T>::calls, (600 - 512) * (50 - 48) + 256 * 16 );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( NestedConvolution, T, test_types )
+{
+	T k[] = { T(1), T(2), T(1), T(0), T(-1), T(0), T(1), T(0), T(2) };
+	weak_matrix<T> kernel(k, 3, 3);
+	auto_matrix<T> m(20, 13);
+	fill_pattern(m, 7, 3, 11, 0);
+	auto_matrix<T> expected(20, 13), result(20, 13);
+	copy_matrix(convolve(convolve(m, kernel, 1, 1), kernel, 1, 1), expected);
+	copy_matrix(convolve(cached(convolve(m, kernel, 1, 1)), kernel, 1, 1), result);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			BOOST_CHECK_EQUAL( result(x, y), expected(x, y) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( ParallelFill, T, test_types )
+{
+	auto_matrix<T> m(700, 300);
+	fill_pattern(m, 7, 3, 11, 0);
+	auto_matrix<T> result(700, 300);
+	copy_matrix(mplus(cached(mmul(m, m)), m), result, par);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			BOOST_CHECK_EQUAL( result(x, y), m(x, y) * m(x, y) + m(x, y) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,100 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <complex>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/convolution.hpp>
+#include <nmpp/constant_kernel.hpp>
+#include <nmpp/tiled.hpp>
+
+#include "test_helpers.hpp"
+
+using namespace nmpp;
+
+typedef boost::mpl::list< double, int, std::complex<float> > test_types;
+
+namespace {
+
+template<class T, class KernelT>
+void check_kernel(size_t width, size_t height, size_t anchor_x, size_t anchor_y)
+{
+	const KernelT kernel;
+	auto_matrix<T> input(width, height), dynamic_kernel(kernel.width(), kernel.height());
+	fill_pattern(input, 7, 3, 11, -5);
+	for (size_t v = 0; v < kernel.height(); ++v)
+		for (size_t u = 0; u < kernel.width(); ++u)
+			dynamic_kernel(u, v) = T(kernel(u, v));
+
+	auto_matrix<T> expected(width, height), rows(width, height), materialized(width, height);
+	copy_matrix(convolve(input, dynamic_kernel, anchor_x, anchor_y), expected);
+	copy_matrix(convolve(input, kernel, anchor_x, anchor_y), rows);
+	convolve(input, kernel, anchor_x, anchor_y, materialized);
+	const detail::convolve_op<auto_matrix<T>, KernelT> op(input, kernel, anchor_x, anchor_y);
+	for (size_t y = 0; y < height; ++y) {
+		for (size_t x = 0; x < width; ++x) {
+			BOOST_CHECK_EQUAL( op(x, y), expected(x, y) );
+			BOOST_CHECK_EQUAL( rows(x, y), expected(x, y) );
+			BOOST_CHECK_EQUAL( materialized(x, y), expected(x, y) );
+		}
+	}
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( ConstantKernel )
+
+BOOST_AUTO_TEST_CASE( Coefficients )
+{
+	const sobel_x kernel;
+	BOOST_CHECK_EQUAL( kernel.width(), 3 );
+	BOOST_CHECK_EQUAL( kernel.height(), 3 );
+	BOOST_CHECK_EQUAL( kernel(0, 1), -2 );
+	BOOST_CHECK_EQUAL( kernel(2, 2), 1 );
+	BOOST_CHECK( sobel_y::row_nonzero(0) );
+	BOOST_CHECK( !sobel_y::row_nonzero(1) );
+	BOOST_CHECK( sobel_y::row_nonzero(2) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( MatchesDynamicKernel, T, test_types )
+{
+	check_kernel<T, sobel_x>(23, 17, 1, 1);
+	check_kernel<T, sobel_y>(23, 17, 1, 1);
+	check_kernel<T, scharr_x>(23, 17, 0, 2);
+	check_kernel<T, scharr_y>(300, 5, 1, 1);
+	check_kernel<T, laplacian>(2, 2, 1, 1);
+	check_kernel<T, binomial>(23, 17, 2, 0);
+	check_kernel<T, constant_kernel<5, 1, 1, 0, -3, 0, 8> >(23, 17, 2, 0);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Tiled, T, test_types )
+{
+	auto_matrix<T> input(70, 50), expected(70, 50), result(70, 50);
+	fill_pattern(input, 7, 3, 11, -5);
+	copy_matrix(convolve(convolve(input, binomial(), 1, 1), sobel_x(), 1, 1), expected);
+	copy_matrix(convolve(convolve(input, binomial(), 1, 1), sobel_x(), 1, 1), result, tiled_policy(32, 8));
+	for (size_t y = 0; y < 50; ++y)
+		for (size_t x = 0; x < 70; ++x)
+			BOOST_CHECK_EQUAL( result(x, y), expected(x, y) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,239 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <complex>
+#include <vector>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/sub_matrix.hpp>
+#include <nmpp/operators.hpp>
+#include <nmpp/convolution.hpp>
+
+#include "test_helpers.hpp"
+
+using namespace nmpp;
+
+typedef boost::mpl::list< double, int, std::complex<float> > test_types;
+
+BOOST_AUTO_TEST_SUITE( Convolution )
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Separable, T, test_types )
+{
+	T a[] = { T(3), T(23), T(17), T(11), T(51), T(97), T(397), T(511), T(2), T(5), T(7), T(13) };
+	T kx[] = { T(1), T(2), T(1) };
+	T ky[] = { T(-1), T(0), T(1) };
+	T k[] = { T(-1), T(-2), T(-1), T(0), T(0), T(0), T(1), T(2), T(1) };
+	weak_matrix<T> m(a, 4, 3);
+	auto_matrix<T> result(4, 3);
+	convolve_separable(m, weak_matrix<T>(kx, 3, 1), weak_matrix<T>(ky, 1, 3), 1, 2, result);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			BOOST_CHECK_EQUAL( result(x, y), convolve(m, weak_matrix<T>(k, 3, 3), 1, 2)(x, y) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( DetectSeparable, T, test_types )
+{
+	T a[] = { T(3), T(23), T(17), T(11), T(51), T(97), T(397), T(511), T(2), T(5), T(7), T(13) };
+	T k[] = { T(1), T(2), T(1), T(2), T(4), T(2), T(1), T(2), T(1) };
+	weak_matrix<T> m(a, 3, 4);
+	weak_matrix<T> kernel(k, 3, 3);
+	auto_matrix<T> result(3, 4);
+	convolve(m, kernel, 0, 1, result);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			BOOST_CHECK_EQUAL( result(x, y), convolve(m, kernel, 0, 1)(x, y) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( NonSeparable, T, test_types )
+{
+	T a[] = { T(3), T(23), T(17), T(11), T(51), T(97), T(397), T(511), T(2), T(5), T(7), T(13) };
+	T k[] = { T(0), T(1), T(0), T(1), T(-4), T(1), T(0), T(1), T(0) };
+	weak_matrix<T> m(a, 4, 3);
+	weak_matrix<T> kernel(k, 3, 3);
+	auto_matrix<T> result(4, 3);
+	convolve(m, kernel, 1, 1, result);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			BOOST_CHECK_EQUAL( result(x, y), convolve(m, kernel, 1, 1)(x, y) );
+}
+
+BOOST_AUTO_TEST_CASE( IntegerImageFloatKernel )
+{
+	auto_matrix<unsigned char> m(64, 64);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			m(x, y) = (unsigned char)((x * 37 + y * 11) % 256);
+	const float taps[] = { 1, 4, 6, 4, 1 };
+	auto_matrix<float> kernel(5, 5), kx(5, 1), ky(1, 5);
+	for (size_t v = 0; v < 5; ++v) {
+		kx(v, 0) = taps[v] / 16;
+		ky(0, v) = taps[v] / 16;
+		for (size_t u = 0; u < 5; ++u)
+			kernel(u, v) = taps[u] * taps[v] / 256;
+	}
+
+	auto_matrix<unsigned char> result(64, 64), lazy(64, 64), separable(64, 64);
+	convolve(m, kernel, 2, 2, result);
+	copy_matrix(convolve(m, kernel, 2, 2), lazy);
+	convolve_separable(m, kx, ky, 2, 2, separable);
+	auto_matrix<float> mf(64, 64), exact(64, 64);
+	mf = m;
+	copy_matrix(convolve(mf, kernel, 2, 2), exact);
+	for (size_t y = 0; y < m.height(); ++y) {
+		for (size_t x = 0; x < m.width(); ++x) {
+			BOOST_CHECK_EQUAL( int(result(x, y)), int(lazy(x, y)) );
+			BOOST_CHECK_SMALL( float(separable(x, y)) - exact(x, y), 1.0f );
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( InteriorAndBorders, T, test_types )
+{
+	T k[] = { T(2), T(-1), T(3), T(1), T(5), T(-2) };
+	weak_matrix<T> kernel(k, 3, 2);
+	auto_matrix<T> m(9, 7);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			m(x, y) = T(int(x * 7 + y * 3) % 11);
+	auto_matrix<T> result(9, 7);
+	for (size_t ay = 0; ay < kernel.height(); ++ay) {
+		for (size_t ax = 0; ax < kernel.width(); ++ax) {
+			convolve(m, kernel, ax, ay, result);
+			for (size_t y = 0; y < m.height(); ++y)
+				for (size_t x = 0; x < m.width(); ++x)
+					BOOST_CHECK_EQUAL( result(x, y), convolve(m, kernel, ax, ay)(x, y) );
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( ReadRow, T, test_types )
+{
+	T k[] = { T(2), T(-1), T(3), T(1), T(5), T(-2) };
+	weak_matrix<T> kernel(k, 3, 2);
+	auto_matrix<T> m(6, 4);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			m(x, y) = T(int(x * 5 + y * 3) % 7);
+	T row[4];
+	for (size_t y = 0; y < m.height(); ++y) {
+		for (size_t x = 0; x + 4 <= m.width(); ++x) {
+			convolve(m, kernel, 2, 1).read_row(x, y, 4, row);
+			for (size_t i = 0; i < 4; ++i)
+				BOOST_CHECK_EQUAL( row[i], convolve(m, kernel, 2, 1)(x + i, y) );
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( KernelWiderThanInput, T, test_types )
+{
+	auto_matrix<T> kernel(100, 1);
+	for (size_t x = 0; x < kernel.width(); ++x)
+		kernel(x, 0) = T(int(x % 3) - 1);
+	auto_matrix<T> m(20, 2);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			m(x, y) = T(int(x * 5 + y * 3) % 7);
+	for (size_t ax = 0; ax < kernel.width(); ax += 33) {
+		auto_matrix<T> result(20, 2);
+		copy_matrix(convolve(m, kernel, ax, 0), result);
+		for (size_t y = 0; y < m.height(); ++y)
+			for (size_t x = 0; x < m.width(); ++x)
+				BOOST_CHECK_EQUAL( result(x, y), convolve(m, kernel, ax, 0)(x, y) );
+	}
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( ReadRowWideKernel, T, test_types )
+{
+	auto_matrix<T> kernel(150, 2);
+	for (size_t y = 0; y < kernel.height(); ++y)
+		for (size_t x = 0; x < kernel.width(); ++x)
+			kernel(x, y) = T(int(x * 3 + y) % 5 - 2);
+	auto_matrix<T> m(600, 3);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			m(x, y) = T(int(x * 5 + y * 3) % 7);
+	std::vector<T> row(590);
+	for (size_t y = 0; y < m.height(); ++y) {
+		convolve(m, kernel, 70, 1).read_row(3, y, row.size(), &row[0]);
+		for (size_t i = 0; i < row.size(); ++i)
+			BOOST_CHECK_EQUAL( row[i], convolve(m, kernel, 70, 1)(3 + i, y) );
+	}
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( ComposedRows, T, test_types )
+{
+	T k[] = { T(2), T(-1), T(3), T(1), T(5), T(-2) };
+	weak_matrix<T> kernel(k, 3, 2);
+	auto_matrix<T> a(5, 4), b(6, 5);
+	for (size_t y = 0; y < b.height(); ++y)
+		for (size_t x = 0; x < b.width(); ++x)
+			b(x, y) = T(int(x * 3 + y * 5) % 13);
+	for (size_t y = 0; y < a.height(); ++y)
+		for (size_t x = 0; x < a.width(); ++x)
+			a(x, y) = b(x, y) + T(1);
+	auto_matrix<T> result(5, 4);
+	copy_matrix(mplus(convolve(a, kernel, 1, 0), offset(b, 1, 1)), result);
+	for (size_t y = 0; y < result.height(); ++y)
+		for (size_t x = 0; x < result.width(); ++x)
+			BOOST_CHECK_EQUAL( result(x, y), convolve(a, kernel, 1, 0)(x, y) + b(x + 1, y + 1) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( FftMatchesDirect, T, test_types )
+{
+	auto_matrix<T> m(150, 50), kernel(13, 11);
+	fill_pattern(m, 7, 3, 23, -11);
+	fill_pattern(kernel, 5, 2, 7, -3);
+	auto_matrix<T> result(150, 50);
+	const size_t anchors[][2] = { { 6, 5 }, { 0, 10 }, { 12, 0 } };
+	for (size_t a = 0; a < 3; ++a) {
+		convolve_fft(m, kernel, anchors[a][0], anchors[a][1], result);
+		for (size_t y = 0; y < m.height(); ++y)
+			for (size_t x = 0; x < m.width(); ++x)
+				BOOST_CHECK_SMALL( double(std::abs(result(x, y) - convolve(m, kernel, anchors[a][0], anchors[a][1])(x, y))), 1e-2 );
+	}
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( FftSmallInput, T, test_types )
+{
+	auto_matrix<T> m(3, 2), kernel(15, 9);
+	fill_pattern(m, 3, 1, 5, -2);
+	fill_pattern(kernel, 2, 5, 9, -4);
+	auto_matrix<T> result(3, 2);
+	convolve_fft(m, kernel, 7, 4, result);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			BOOST_CHECK_SMALL( double(std::abs(result(x, y) - convolve(m, kernel, 7, 4)(x, y))), 1e-2 );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( LargeKernelSwitch, T, test_types )
+{
+	auto_matrix<T> m(40, 30), kernel(12, 12);
+	fill_pattern(m, 3, 7, 17, -8);
+	fill_pattern(kernel, 5, 3, 11, -5);
+	auto_matrix<T> result(40, 30);
+	convolve(m, kernel, 5, 6, result);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			BOOST_CHECK_SMALL( double(std::abs(result(x, y) - convolve(m, kernel, 5, 6)(x, y))), 1e-2 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
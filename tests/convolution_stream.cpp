@@ -0,0 +1,107 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <complex>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/convolution.hpp>
+#include <nmpp/convolution_stream.hpp>
+
+#include "test_helpers.hpp"
+
+using namespace nmpp;
+
+typedef boost::mpl::list< double, int, std::complex<float> > test_types;
+
+namespace {
+
+template<class T>
+void check_stream(size_t width, size_t height, size_t kernel_width, size_t kernel_height, size_t anchor_x, size_t anchor_y)
+{
+	auto_matrix<T> input(width, height), kernel(kernel_width, kernel_height);
+	fill_pattern(input, 7, 3, 11, -5, 0);
+	fill_pattern(kernel, 7, 3, 11, -5, 3);
+	auto_matrix<T> expected(width, height), result(width, height);
+	copy_matrix(convolve(input, kernel, anchor_x, anchor_y), expected);
+
+	convolution_stream<T> stream(width, kernel, anchor_x, anchor_y);
+	for (size_t y = 0; y < height; ++y) {
+		stream.push_row(input, y);
+		while (stream.ready())
+			stream.pop_row(result, stream.rows_popped());
+		BOOST_CHECK_EQUAL( stream.rows_popped(), y + 1 > kernel_height - 1 - anchor_y ? y + 1 - (kernel_height - 1 - anchor_y) : 0 );
+	}
+	stream.finish();
+	while (stream.ready())
+		stream.pop_row(result, stream.rows_popped());
+	BOOST_CHECK( stream.done() );
+
+	check_equal(result, expected);
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( ConvolutionStream )
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( MatchesConvolve, T, test_types )
+{
+	check_stream<T>(23, 17, 3, 3, 1, 1);
+	check_stream<T>(23, 17, 5, 3, 0, 2);
+	check_stream<T>(23, 17, 1, 7, 0, 0);
+	check_stream<T>(23, 17, 4, 6, 3, 4);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( ShortInput, T, test_types )
+{
+	check_stream<T>(9, 2, 5, 5, 2, 2);
+	check_stream<T>(1, 1, 3, 3, 1, 1);
+	check_stream<T>(3, 4, 7, 7, 6, 0);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( RawRows, T, test_types )
+{
+	auto_matrix<T> input(16, 12), kernel(3, 3);
+	fill_pattern(input, 7, 3, 11, -5, 1);
+	fill_pattern(kernel, 7, 3, 11, -5, 5);
+	auto_matrix<T> expected(16, 12), row(16, 1);
+	copy_matrix(convolve(input, kernel, 1, 1), expected);
+
+	convolution_stream<T> stream(16, kernel, 1, 1);
+	size_t y = 0;
+	for (size_t i = 0; i < 12; ++i) {
+		stream.push_row(&input(0, i));
+		for (; stream.ready(); ++y) {
+			stream.pop_row(row.get());
+			for (size_t x = 0; x < 16; ++x)
+				BOOST_CHECK_EQUAL( row(x, 0), expected(x, y) );
+		}
+	}
+	stream.finish();
+	for (; stream.ready(); ++y) {
+		stream.pop_row(row.get());
+		for (size_t x = 0; x < 16; ++x)
+			BOOST_CHECK_EQUAL( row(x, 0), expected(x, y) );
+	}
+	BOOST_CHECK_EQUAL( y, 12 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
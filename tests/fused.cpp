@@ -0,0 +1,84 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <complex>
+#include <tuple>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/operators.hpp>
+#include <nmpp/convolution.hpp>
+#include <nmpp/fused.hpp>
+
+using namespace nmpp;
+
+typedef boost::mpl::list< double, int, std::complex<float> > test_types;
+
+BOOST_AUTO_TEST_SUITE( Fused )
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( MatchesSeparatePasses, T, test_types )
+{
+	T kx[] = { T(-1), T(0), T(1), T(-2), T(0), T(2), T(-1), T(0), T(1) };
+	T ky[] = { T(-1), T(-2), T(-1), T(0), T(0), T(0), T(1), T(2), T(1) };
+	weak_matrix<T> sobel_x(kx, 3, 3), sobel_y(ky, 3, 3);
+	auto_matrix<T> img(23, 17);
+	for (size_t y = 0; y < img.height(); ++y)
+		for (size_t x = 0; x < img.width(); ++x)
+			img(x, y) = T(int(x * 7 + y * 3) % 11);
+
+	auto_matrix<T> gx(23, 17), gy(23, 17), mag(23, 17);
+	copy_matrices(std::tie(gx, gy, mag),
+		convolve(img, sobel_x, 1, 1),
+		convolve(img, sobel_y, 1, 1),
+		mplus(mmul(convolve(img, sobel_x, 1, 1), convolve(img, sobel_x, 1, 1)),
+			mmul(convolve(img, sobel_y, 1, 1), convolve(img, sobel_y, 1, 1))));
+
+	for (size_t y = 0; y < img.height(); ++y) {
+		for (size_t x = 0; x < img.width(); ++x) {
+			const T ex = convolve(img, sobel_x, 1, 1)(x, y);
+			const T ey = convolve(img, sobel_y, 1, 1)(x, y);
+			BOOST_CHECK_EQUAL( gx(x, y), ex );
+			BOOST_CHECK_EQUAL( gy(x, y), ey );
+			BOOST_CHECK_EQUAL( mag(x, y), ex * ex + ey * ey );
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( MixedOutputs )
+{
+	auto_matrix<int> a(5, 4, 3);
+	auto_matrix<double> out1(5, 4);
+	auto_matrix<int> storage(7, 6, 0);
+	weak_matrix<int> out2(storage.get(), 5, 4, 7);
+	copy_matrices(std::tie(out1, out2), a, mplus(a, a));
+	BOOST_CHECK_EQUAL( out1(4, 3), 3.0 );
+	BOOST_CHECK_EQUAL( out2(4, 3), 6 );
+	BOOST_CHECK_EQUAL( storage(5, 0), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( SingleOutput )
+{
+	auto_matrix<int> a(5, 4, 3), out(5, 4);
+	copy_matrices(std::tie(out), a);
+	BOOST_CHECK_EQUAL( out(2, 2), 3 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,201 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Built into instrumentation_runner rather than test_runner, so that every
+// translation unit sharing these template instantiations is instrumented.
+#define NMPP_INSTRUMENTATION
+
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/convolution.hpp>
+#include <nmpp/constant_kernel.hpp>
+#include <nmpp/upsample.hpp>
+#include <nmpp/parallel.hpp>
+#include <nmpp/fused.hpp>
+#include <nmpp/tiled.hpp>
+#include <nmpp/instrumentation.hpp>
+
+using namespace nmpp;
+using namespace nmpp::instrumentation;
+
+BOOST_AUTO_TEST_SUITE( Instrumentation )
+
+BOOST_AUTO_TEST_CASE( NoSinkRecordsNothing )
+{
+	BOOST_CHECK_EQUAL( get_sink(), (sink*)0 );
+	auto_matrix<short> a(8, 8, 1), b(8, 8);
+	copy_matrix(a, b);
+	BOOST_CHECK_EQUAL( b(7, 7), 1 );
+}
+
+BOOST_AUTO_TEST_CASE( CallbackReceivesEvents )
+{
+	std::vector<event> events;
+	callback_sink callback([&](const event& e) { events.push_back(e); });
+	{
+		scoped_sink installed(callback);
+		BOOST_CHECK_EQUAL( get_sink(), &callback );
+		auto_matrix<short> a(10, 6, 2);
+		auto_matrix<long long> b(10, 6);
+		copy_matrix(a, b);
+	}
+	BOOST_CHECK_EQUAL( get_sink(), (sink*)0 );
+	BOOST_REQUIRE_EQUAL( events.size(), 1 );
+	BOOST_CHECK_EQUAL( std::string(events[0].site->name), "copy_matrix" );
+	BOOST_CHECK_EQUAL( events[0].elements, 60 );
+	BOOST_CHECK_EQUAL( events[0].bytes_read, 60 * sizeof(short) );
+	BOOST_CHECK_EQUAL( events[0].bytes_written, 60 * sizeof(long long) );
+	BOOST_CHECK_EQUAL( events[0].depth, 0 );
+	BOOST_CHECK_GE( events[0].seconds, 0 );
+}
+
+BOOST_AUTO_TEST_CASE( NestedCallsHaveDepth )
+{
+	std::vector<event> events;
+	callback_sink callback([&](const event& e) { events.push_back(e); });
+	scoped_sink installed(callback);
+	auto_matrix<short> input(16, 16, 1), output(16, 16);
+	auto_matrix<short> kernel(3, 3, 1);
+	convolve(input, kernel, 1, 1, output);
+	BOOST_CHECK_EQUAL( output(8, 8), 9 );
+	BOOST_REQUIRE_EQUAL( events.size(), 2 );
+	BOOST_CHECK_EQUAL( std::string(events[0].site->name), "convolve_separable" );
+	BOOST_CHECK_EQUAL( events[0].depth, 1 );
+	BOOST_CHECK_EQUAL( std::string(events[1].site->name), "convolve" );
+	BOOST_CHECK_EQUAL( events[1].depth, 0 );
+	BOOST_CHECK_LE( events[0].seconds, events[1].seconds );
+}
+
+BOOST_AUTO_TEST_CASE( RemovedSinkIsNotWritten )
+{
+	std::vector<event> events;
+	callback_sink callback([&](const event& e) { events.push_back(e); set_sink(0); });
+	set_sink(&callback);
+	auto_matrix<short> input(16, 16, 1), output(16, 16);
+	auto_matrix<short> kernel(3, 3, 1);
+	convolve(input, kernel, 1, 1, output);
+	BOOST_CHECK_EQUAL( get_sink(), (sink*)0 );
+	BOOST_REQUIRE_EQUAL( events.size(), 1 );
+	BOOST_CHECK_EQUAL( std::string(events[0].site->name), "convolve_separable" );
+}
+
+BOOST_AUTO_TEST_CASE( ConstantKernelConvolve )
+{
+	std::vector<event> events;
+	callback_sink callback([&](const event& e) { events.push_back(e); });
+	scoped_sink installed(callback);
+	auto_matrix<short> input(16, 16, 1), output(16, 16);
+	convolve(input, sobel_x(), 1, 1, output);
+	BOOST_CHECK_EQUAL( output(8, 8), 0 );
+	BOOST_REQUIRE_EQUAL( events.size(), 2 );
+	BOOST_CHECK_EQUAL( std::string(events[0].site->name), "copy_matrix" );
+	BOOST_CHECK_EQUAL( events[0].depth, 1 );
+	BOOST_CHECK_EQUAL( std::string(events[1].site->name), "convolve" );
+	BOOST_CHECK_EQUAL( events[1].depth, 0 );
+	BOOST_CHECK_EQUAL( events[1].elements, 256 );
+}
+
+BOOST_AUTO_TEST_CASE( AggregatePerCallSite )
+{
+	aggregate_sink totals;
+	scoped_sink installed(totals);
+	auto_matrix<short> input(4, 4, 3), output(8, 8);
+	upsample_nearest(input, output);
+	upsample_nearest(input, output);
+	upsample_bilinear(input, output);
+	copy_matrix(input, output, par);
+
+	const aggregate_sink::snapshot_type snapshot = totals.snapshot();
+	BOOST_REQUIRE_EQUAL( snapshot.size(), 3 );
+	for (aggregate_sink::snapshot_type::const_iterator i = snapshot.begin(); i != snapshot.end(); ++i) {
+		if (i->first.find("upsample_nearest") == 0) {
+			BOOST_CHECK_EQUAL( i->second.calls, 2 );
+			BOOST_CHECK_EQUAL( i->second.elements, 2 * 64 );
+			BOOST_CHECK_EQUAL( i->second.bytes_read, 2 * 16 * sizeof(short) );
+		} else if (i->first.find("copy_matrix(par)") == 0) {
+			BOOST_CHECK_EQUAL( i->second.calls, 1 );
+			BOOST_CHECK_EQUAL( i->second.elements, 16 );
+		} else {
+			BOOST_CHECK_EQUAL( i->first.find("upsample_bilinear"), 0 );
+			BOOST_CHECK_NE( i->first.find("upsample.hpp:"), std::string::npos );
+		}
+	}
+	totals.reset();
+	BOOST_CHECK( totals.snapshot().empty() );
+}
+
+BOOST_AUTO_TEST_CASE( ChromeTrace )
+{
+	trace_sink trace;
+	{
+		scoped_sink installed(trace);
+		auto_matrix<short> a(5, 5, 1), b(5, 5);
+		copy_matrix(a, b);
+	}
+	BOOST_CHECK_EQUAL( trace.size(), 1 );
+	std::ostringstream out;
+	trace.write(out);
+	const std::string json = out.str();
+	BOOST_CHECK_EQUAL( json.find("{\"traceEvents\":["), 0 );
+	BOOST_CHECK_NE( json.find("\"name\":\"copy_matrix\""), std::string::npos );
+	BOOST_CHECK_NE( json.find("\"ph\":\"X\""), std::string::npos );
+	BOOST_CHECK_NE( json.find("\"elements\":25"), std::string::npos );
+	trace.clear();
+	BOOST_CHECK_EQUAL( trace.size(), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( TraceTimestampsAreFixedPoint )
+{
+	static const call_site site = { "late", "file.cpp", 7 };
+	event e;
+	e.site = &site;
+	e.start = 2.5;
+	e.seconds = 1500.25;
+	e.thread = 0;
+	e.depth = 0;
+	e.elements = e.bytes_read = e.bytes_written = 0;
+	trace_sink trace;
+	trace.record(e);
+	std::ostringstream out;
+	out.precision(2);
+	trace.write(out);
+	const std::string json = out.str();
+	BOOST_CHECK_NE( json.find("\"ts\":2500000.000,"), std::string::npos );
+	BOOST_CHECK_NE( json.find("\"dur\":1500250000.000,"), std::string::npos );
+	BOOST_CHECK_EQUAL( json.find("e+"), std::string::npos );
+	BOOST_CHECK_EQUAL( out.precision(), 2 );
+}
+
+BOOST_AUTO_TEST_CASE( FusedAndTiledCopies )
+{
+	std::vector<std::string> names;
+	callback_sink callback([&](const event& e) { names.push_back(e.site->name); });
+	scoped_sink installed(callback);
+	auto_matrix<short> a(40, 30, 1), b(40, 30), c(40, 30);
+	copy_matrices(std::tie(b, c), a, a);
+	copy_matrix(a, b, tiled_policy(16, 16));
+	BOOST_REQUIRE_EQUAL( names.size(), 2 );
+	BOOST_CHECK_EQUAL( names[0], "copy_matrices" );
+	BOOST_CHECK_EQUAL( names[1], "copy_matrix(tiled)" );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <complex>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/convolution.hpp>
+#include <nmpp/integral_image.hpp>
+
+#include "test_helpers.hpp"
+
+using namespace nmpp;
+
+typedef boost::mpl::list< double, int, std::complex<float> > test_types;
+
+BOOST_AUTO_TEST_SUITE( IntegralImage )
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( RectangleSums, T, test_types )
+{
+	auto_matrix<T> m(9, 7);
+	fill_pattern(m, 7, 3, 11, 0);
+	integral_image<T> table(m);
+	BOOST_CHECK_EQUAL( table.width(), 9 );
+	BOOST_CHECK_EQUAL( table.height(), 7 );
+	for (size_t y = 0; y < m.height(); ++y) {
+		for (size_t x = 0; x < m.width(); ++x) {
+			for (size_t h = 1; y + h <= m.height(); h += 2) {
+				for (size_t w = 1; x + w <= m.width(); w += 3) {
+					T expected = T(0);
+					for (size_t v = 0; v < h; ++v)
+						for (size_t u = 0; u < w; ++u)
+							expected += m(x + u, y + v);
+					BOOST_CHECK_EQUAL( static_cast<T>(table.sum(x, y, w, h)), expected );
+				}
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( WideAccumulator )
+{
+	auto_matrix<unsigned char> m(300, 2, 255);
+	integral_image<unsigned char> table(m);
+	BOOST_CHECK_EQUAL( table.sum(0, 0, 300, 2), 255u * 600u );
+}
+
+BOOST_AUTO_TEST_CASE( SixteenBitOverflowRange )
+{
+	auto_matrix<short> m(300, 300, 30000);
+	integral_image<short> table(m);
+	BOOST_CHECK_EQUAL( table(300, 300), 30000ll * 300 * 300 );
+	BOOST_CHECK_EQUAL( table.sum(1, 1, 299, 299), 30000ll * 299 * 299 );
+	auto_matrix<unsigned short> u(300, 300, 65535);
+	integral_image<unsigned short> utable(u);
+	BOOST_CHECK_EQUAL( utable.sum(0, 0, 300, 300), 65535ull * 300 * 300 );
+	auto_matrix<short> mean(300, 300);
+	box_filter(m, 5, 5, mean);
+	BOOST_CHECK_EQUAL( mean(299, 299), 30000 );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( BoxSumMatchesConvolve, T, test_types )
+{
+	auto_matrix<T> m(13, 10);
+	fill_pattern(m, 7, 3, 11, 0);
+	auto_matrix<T> result(13, 10);
+	const size_t sizes[][4] = { { 3, 3, 1, 1 }, { 5, 2, 0, 1 }, { 1, 7, 0, 6 }, { 17, 4, 8, 3 }, { 2, 15, 1, 14 } };
+	for (size_t s = 0; s < 5; ++s) {
+		const auto_matrix<T> kernel(sizes[s][0], sizes[s][1], T(1));
+		box_sum(m, sizes[s][0], sizes[s][1], sizes[s][2], sizes[s][3], result);
+		for (size_t y = 0; y < m.height(); ++y)
+			for (size_t x = 0; x < m.width(); ++x)
+				BOOST_CHECK_EQUAL( result(x, y), convolve(m, kernel, sizes[s][2], sizes[s][3])(x, y) );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( BoxFilterMean )
+{
+	auto_matrix<double> m(8, 6);
+	fill_pattern(m, 7, 3, 11, 0);
+	auto_matrix<double> result(8, 6);
+	box_filter(m, 3, 5, result);
+	const auto_matrix<double> kernel(3, 5, 1.0 / 15);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			BOOST_CHECK_CLOSE( result(x, y), convolve(m, kernel, 1, 2)(x, y), 1e-9 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
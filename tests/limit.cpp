@@ -21,6 +21,7 @@
 #include <boost/mpl/list.hpp>
 #include <complex>
 
+#include <nmpp/auto_matrix.hpp>
 #include <nmpp/weak_matrix.hpp>
 #include <nmpp/sub_matrix.hpp>
 
@@ -43,4 +44,45 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( CreateAndCheck, T, test_types )
 	BOOST_CHECK_EQUAL( limit(m, 3, 1)(2, 0), T(17) );
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( NestedOffsetIsDense, T, test_types )
+{
+	auto_matrix<T> m(5, 4);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			m(x, y) = T(int(y * 5 + x));
+	weak_matrix<T> roi = offset(limit(m, 4, 3), 1, 1);
+	BOOST_CHECK_EQUAL( roi.width(), 3 );
+	BOOST_CHECK_EQUAL( roi.height(), 2 );
+	BOOST_CHECK_EQUAL( roi.pitch(), m.width() );
+	BOOST_CHECK_EQUAL( roi.get(), &m(1, 1) );
+	BOOST_CHECK_EQUAL( roi(2, 1), m(3, 2) );
+	T sevens[] = { T(7), T(7) };
+	weak_matrix<T> inner = offset(roi, 1, 1);
+	copy_matrix(weak_matrix<T>(sevens, 2, 1), inner);
+	BOOST_CHECK_EQUAL( m(2, 2), T(7) );
+	BOOST_CHECK_EQUAL( m(3, 2), T(7) );
+	BOOST_CHECK_EQUAL( m(4, 2), T(14) );
+	BOOST_CHECK_EQUAL( m(1, 2), T(11) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( AssignCopies, T, test_types )
+{
+	auto_matrix<T> dst(3, 3, T(0));
+	T a[] = { T(1), T(2), T(3), T(4) };
+	weak_matrix<T> src(a, 2, 2);
+	limit(dst, 2, 2) = src;
+	BOOST_CHECK_EQUAL( dst(0, 0), T(1) );
+	BOOST_CHECK_EQUAL( dst(1, 1), T(4) );
+	BOOST_CHECK_EQUAL( dst(2, 2), T(0) );
+
+	auto_matrix<T> other(3, 1, T(8));
+	weak_matrix<T> view(dst);
+	limit(view, 3, 1) = other;
+	BOOST_CHECK_EQUAL( dst(2, 0), T(8) );
+	BOOST_CHECK_EQUAL( dst(1, 1), T(4) );
+
+	limit(dst, 1, 1) = limit(other, 1, 1);
+	BOOST_CHECK_EQUAL( dst(0, 0), T(8) );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
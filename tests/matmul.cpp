@@ -0,0 +1,85 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <complex>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/sub_matrix.hpp>
+#include <nmpp/matmul.hpp>
+
+#include "test_helpers.hpp"
+
+using namespace nmpp;
+
+typedef boost::mpl::list< double, int, std::complex<float>, float > test_types;
+
+BOOST_AUTO_TEST_SUITE( Matmul )
+
+template<class T, class LeftT, class RightT, class OutputT>
+void check_product(const LeftT& a, const RightT& b, const OutputT& c)
+{
+	for (size_t y = 0; y < a.height(); ++y) {
+		for (size_t x = 0; x < b.width(); ++x) {
+			T expected = T(0);
+			for (size_t p = 0; p < a.width(); ++p)
+				expected += a(p, y) * b(x, p);
+			BOOST_CHECK_EQUAL( c(x, y), expected );
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Shapes, T, test_types )
+{
+	const size_t shapes[][3] = { { 1, 1, 1 }, { 5, 3, 7 }, { 37, 300, 41 }, { 130, 20, 9 }, { 4, 16, 8 } };
+	for (size_t s = 0; s < 5; ++s) {
+		auto_matrix<T> a(shapes[s][1], shapes[s][0]), b(shapes[s][2], shapes[s][1]);
+		auto_matrix<T> c(shapes[s][2], shapes[s][0], T(99));
+		fill_pattern(a, 3, 5, 7, -3);
+		fill_pattern(b, 2, 3, 7, -3);
+		matmul(a, b, c);
+		check_product<T>(a, b, c);
+	}
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( StridedViews, T, test_types )
+{
+	auto_matrix<T> a(40, 30), b(25, 35), c(20, 20, T(0));
+	fill_pattern(a, 3, 5, 7, -3);
+	fill_pattern(b, 2, 3, 7, -3);
+	weak_matrix<T> av = limit(offset(a, 3, 2), 17, 11);
+	weak_matrix<T> bv = limit(offset(b, 1, 4), 13, 17);
+	weak_matrix<T> cv = limit(offset(c, 2, 3), 13, 11);
+	matmul(av, bv, cv);
+	check_product<T>(av, bv, cv);
+	BOOST_CHECK_EQUAL( c(0, 0), T(0) );
+	BOOST_CHECK_EQUAL( c(15, 14), T(0) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( EmptyDepth, T, test_types )
+{
+	auto_matrix<T> a(0, 3), b(4, 0), c(4, 3, T(5));
+	matmul(a, b, c);
+	BOOST_CHECK_EQUAL( c(0, 0), T(0) );
+	BOOST_CHECK_EQUAL( c(3, 2), T(0) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,214 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <complex>
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/sub_matrix.hpp>
+#include <nmpp/operators.hpp>
+#include <nmpp/mmap_matrix.hpp>
+#include <nmpp/matrix_io.hpp>
+
+#include "test_helpers.hpp"
+
+using namespace nmpp;
+
+typedef boost::mpl::list< double, int, std::complex<float> > test_types;
+typedef boost::mpl::list< double, int, float > real_types;
+
+BOOST_AUTO_TEST_SUITE( MatrixIO )
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( RoundTrip, T, test_types )
+{
+	temp_file file;
+	auto_matrix<T> m(37, 23);
+	fill_pattern(m, 7, 3, 11, 2);
+	write_matrix(file.path, m);
+
+	auto_matrix<T> result;
+	read_matrix(file.path, result);
+	check_equal(result, m);
+
+	auto_matrix<T> storage(37, 23);
+	weak_matrix<T> view(storage);
+	read_matrix(file.path, view);
+	check_equal(storage, m);
+
+	auto_matrix<T> wrong(36, 23);
+	weak_matrix<T> wrong_view(wrong);
+	BOOST_CHECK_THROW( read_matrix(file.path, wrong_view), std::runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( WriteExpression, T, test_types )
+{
+	temp_file file;
+	auto_matrix<T> m(19, 11), expected(12, 11);
+	fill_pattern(m, 7, 3, 11, 2);
+	write_matrix(file.path, mplus(limit(m, 12, 11), limit(m, 12, 11)));
+	copy_matrix(mplus(limit(m, 12, 11), limit(m, 12, 11)), expected);
+
+	auto_matrix<T> result;
+	read_matrix(file.path, result);
+	check_equal(result, expected);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Strips, T, test_types )
+{
+	temp_file file;
+	auto_matrix<T> m(29, 50);
+	fill_pattern(m, 7, 3, 11, 2);
+	{
+		matrix_writer<T> writer(file.path, 29, 50);
+		for (size_t y = 0; y < 50; y += 16)
+			writer.write(limit(offset(m, 0, y), 29, std::min<size_t>(16, 50 - y)));
+		BOOST_CHECK( writer.done() );
+		writer.close();
+	}
+
+	matrix_reader<T> reader(file.path);
+	BOOST_REQUIRE_EQUAL( reader.width(), 29 );
+	BOOST_REQUIRE_EQUAL( reader.height(), 50 );
+	auto_matrix<T> band(29, 16);
+	while (!reader.done()) {
+		const size_t y = reader.row();
+		const size_t count = reader.read(band);
+		BOOST_REQUIRE_GT( count, 0 );
+		for (size_t row = 0; row < count; ++row)
+			for (size_t x = 0; x < 29; ++x)
+				BOOST_CHECK_EQUAL( band(x, row), m(x, y + row) );
+	}
+	BOOST_CHECK_EQUAL( reader.read(band), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( IncompleteWriter )
+{
+	temp_file file;
+	matrix_writer<int> writer(file.path, 4, 4);
+	writer.write(auto_matrix<int>(4, 2, 1));
+	BOOST_CHECK_THROW( writer.close(), std::runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE( PitchNarrowerThanWidth )
+{
+	temp_file file;
+	write_matrix(file.path, auto_matrix<int>(4, 1, 3));
+	{
+		std::FILE* f = std::fopen(file.path.c_str(), "r+b");
+		BOOST_REQUIRE( f );
+		const uint64_t pitch = 2;
+		BOOST_REQUIRE_EQUAL( std::fseek(f, offsetof(matrix_file_header, pitch), SEEK_SET), 0 );
+		BOOST_REQUIRE_EQUAL( std::fwrite(&pitch, sizeof(pitch), 1, f), 1u );
+		std::fclose(f);
+	}
+	auto_matrix<int> m;
+	BOOST_CHECK_THROW( read_matrix(file.path, m), std::runtime_error );
+	BOOST_CHECK_THROW( mmap_matrix<const int> mapped(file.path), std::runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( MmapInterop, T, test_types )
+{
+	temp_file file;
+	auto_matrix<T> m(37, 9);
+	fill_pattern(m, 7, 3, 11, 2);
+	{
+		mmap_matrix<T> mapped(file.path, 37, 9);
+		BOOST_REQUIRE_GT( mapped.pitch(), mapped.width() );
+		copy_matrix(m, mapped);
+	}
+	auto_matrix<T> result;
+	read_matrix(file.path, result);
+	check_equal(result, m);
+
+	matrix_reader<T> reader(file.path);
+	auto_matrix<T> band(37, 4);
+	size_t y = 0;
+	while (!reader.done()) {
+		const size_t count = reader.read(band);
+		for (size_t row = 0; row < count; ++row)
+			for (size_t x = 0; x < 37; ++x)
+				BOOST_CHECK_EQUAL( band(x, row), m(x, y + row) );
+		y += count;
+	}
+	BOOST_CHECK_EQUAL( y, 9 );
+
+	write_matrix(file.path, m);
+	const mmap_matrix<const T> mapped(file.path);
+	check_equal(m, mapped);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Pgm, T, real_types )
+{
+	temp_file file;
+	auto_matrix<T> m(21, 13);
+	fill_pattern(m, 7, 3, 11, 2);
+	write_pgm(file.path, m);
+	auto_matrix<T> result;
+	read_pgm(file.path, result);
+	check_equal(result, m);
+
+	m(3, 4) = T(1000);
+	write_pgm(file.path, m, 65535);
+	read_pgm(file.path, result);
+	check_equal(result, m);
+
+	m(3, 4) = T(-7);
+	write_pgm(file.path, m);
+	read_pgm(file.path, result);
+	BOOST_CHECK_EQUAL( result(3, 4), T(0) );
+}
+
+BOOST_AUTO_TEST_CASE( PgmComments )
+{
+	temp_file file;
+	{
+		std::FILE* f = std::fopen(file.path.c_str(), "wb");
+		BOOST_REQUIRE( f );
+		std::fputs("P5\n# comment\n3 2\n# another\n255\n", f);
+		const unsigned char pixels[] = { 1, 2, 3, 4, 5, 6 };
+		std::fwrite(pixels, 1, sizeof(pixels), f);
+		std::fclose(f);
+	}
+	auto_matrix<int> result;
+	read_pgm(file.path, result);
+	BOOST_REQUIRE_EQUAL( result.width(), 3 );
+	BOOST_REQUIRE_EQUAL( result.height(), 2 );
+	BOOST_CHECK_EQUAL( result(0, 0), 1 );
+	BOOST_CHECK_EQUAL( result(2, 1), 6 );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Pfm, T, real_types )
+{
+	temp_file file;
+	auto_matrix<T> m(17, 6);
+	fill_pattern(m, 7, 3, 11, 2);
+	m(0, 0) = T(-3);
+	write_pfm(file.path, m);
+	auto_matrix<T> result;
+	read_pfm(file.path, result);
+	check_equal(result, m);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
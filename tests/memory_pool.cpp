@@ -0,0 +1,138 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <complex>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/convolution.hpp>
+#include <nmpp/matmul.hpp>
+#include <nmpp/tiled.hpp>
+#include <nmpp/memory_pool.hpp>
+
+using namespace nmpp;
+
+typedef boost::mpl::list< double, int, std::complex<float> > test_types;
+
+BOOST_AUTO_TEST_SUITE( MemoryPool )
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( RecyclesBuffers, T, test_types )
+{
+	T* first = 0;
+	{
+		auto_matrix<T, pool_allocation> m(31, 17);
+		first = m.get();
+		BOOST_CHECK_EQUAL( reinterpret_cast<size_t>(first) % memory_pool::alignment, 0 );
+	}
+	BOOST_CHECK_GT( memory_pool::global().cached(), 0 );
+	auto_matrix<T, pool_allocation> m(31, 17, T(3));
+	BOOST_CHECK_EQUAL( m.get(), first );
+	BOOST_CHECK_EQUAL( m(30, 16), T(3) );
+	memory_pool::global().trim();
+	BOOST_CHECK_EQUAL( memory_pool::global().cached(), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( SizeClasses )
+{
+	BOOST_CHECK_EQUAL( memory_pool::size_class(1), 64 );
+	BOOST_CHECK_EQUAL( memory_pool::size_class(64), 64 );
+	BOOST_CHECK_EQUAL( memory_pool::size_class(65), 128 );
+	BOOST_CHECK_GE( memory_pool::size_class(1000), 1000 );
+	BOOST_CHECK_LE( memory_pool::size_class(100000), 100000 + 100000 / 4 );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( ScopedArena, T, test_types )
+{
+	memory_pool::global().trim();
+	{
+		scoped_arena arena(1 << 16);
+		auto_matrix<T, pool_allocation> m1(10, 10, T(1));
+		auto_matrix<T, pool_allocation> m2(10, 10, T(2));
+		BOOST_CHECK_EQUAL( memory_pool::header(m1.get())->arena, &arena );
+		BOOST_CHECK_EQUAL( reinterpret_cast<size_t>(m2.get()) % memory_pool::alignment, 0 );
+		BOOST_CHECK_GT( m2.get(), m1.get() );
+		BOOST_CHECK_EQUAL( m1(9, 9), T(1) );
+		BOOST_CHECK_EQUAL( m2(0, 0), T(2) );
+		BOOST_CHECK_EQUAL( memory_pool::global().cached(), 0 );
+	}
+	BOOST_CHECK_EQUAL( scoped_arena::current(), (scoped_arena*)0 );
+	BOOST_CHECK_GE( memory_pool::global().cached(), 1 << 16 );
+	memory_pool::global().trim();
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( TemporariesUseArena, T, test_types )
+{
+	memory_pool::global().trim();
+	{
+		auto_matrix<T, temporary_allocation> m(10, 10, T(4));
+		BOOST_CHECK_EQUAL( reinterpret_cast<size_t>(m.get()) % temporary_allocation::alignment, 0 );
+		BOOST_CHECK_EQUAL( m.pitch(), 10 );
+		BOOST_CHECK_EQUAL( m(9, 9), T(4) );
+	}
+	BOOST_CHECK_EQUAL( memory_pool::global().cached(), 0 );
+	{
+		scoped_arena arena(1 << 16);
+		auto_matrix<T, temporary_allocation> m1(10, 10, T(1));
+		auto_matrix<T, temporary_allocation> m2(10, 10, T(2));
+		BOOST_CHECK_GT( m2.get(), m1.get() );
+		BOOST_CHECK_EQUAL( m1(9, 9), T(1) );
+		BOOST_CHECK_EQUAL( m2(0, 0), T(2) );
+	}
+	BOOST_CHECK_GE( memory_pool::global().cached(), 1 << 16 );
+	memory_pool::global().trim();
+}
+
+BOOST_AUTO_TEST_CASE( ConvolutionUsesArena )
+{
+	auto_matrix<double> input(40, 30), expected(40, 30), output(40, 30);
+	for (size_t y = 0; y < input.height(); ++y)
+		for (size_t x = 0; x < input.width(); ++x)
+			input(x, y) = double((x * 7 + y * 3) % 11);
+	double k[] = { 1, 2, 1, 2, 4, 2, 1, 2, 1 };
+	weak_matrix<double> kernel(k, 3, 3);
+	convolve(input, kernel, 1, 1, expected);
+
+	memory_pool::global().trim();
+	{
+		scoped_arena arena(1 << 16);
+		convolve(input, kernel, 1, 1, output);
+	}
+	BOOST_CHECK_GE( memory_pool::global().cached(), 1 << 16 );
+	memory_pool::global().trim();
+	for (size_t y = 0; y < output.height(); ++y)
+		for (size_t x = 0; x < output.width(); ++x)
+			BOOST_CHECK_EQUAL( output(x, y), expected(x, y) );
+}
+
+BOOST_AUTO_TEST_CASE( ScratchStaysOutOfArena )
+{
+	auto_matrix<double> a(200, 200, 1.0), b(200, 200, 2.0), c(200, 200);
+	double k[] = { 1, 2, 1, 2, 4, 2, 1, 2, 1 };
+	weak_matrix<double> kernel(k, 3, 3);
+	scoped_arena arena;
+	for (int i = 0; i < 4; ++i) {
+		matmul(a, b, c);
+		copy_matrix(convolve(convolve(a, kernel, 1, 1), kernel, 1, 1), c, tiled_policy(32, 32));
+	}
+	BOOST_CHECK_EQUAL( arena.reserved(), 0 );
+	BOOST_CHECK_EQUAL( c(100, 100), 256.0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
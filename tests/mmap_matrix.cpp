@@ -0,0 +1,154 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <complex>
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/sub_matrix.hpp>
+#include <nmpp/convolution.hpp>
+#include <nmpp/mmap_matrix.hpp>
+
+#include "test_helpers.hpp"
+
+using namespace nmpp;
+
+typedef boost::mpl::list< double, int, std::complex<float> > test_types;
+
+static void patch_header(const std::string& path, size_t offset, uint64_t value)
+{
+	std::FILE* f = std::fopen(path.c_str(), "r+b");
+	BOOST_REQUIRE( f );
+	BOOST_REQUIRE_EQUAL( std::fseek(f, offset, SEEK_SET), 0 );
+	BOOST_REQUIRE_EQUAL( std::fwrite(&value, sizeof(value), 1, f), 1u );
+	std::fclose(f);
+}
+
+BOOST_AUTO_TEST_SUITE( MmapMatrix )
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( CreateAndReopen, T, test_types )
+{
+	temp_file file;
+	{
+		mmap_matrix<T> m(file.path, 37, 23);
+		BOOST_CHECK_EQUAL( m.width(), 37 );
+		BOOST_CHECK_EQUAL( m.height(), 23 );
+		BOOST_CHECK_GE( m.pitch(), m.width() );
+		BOOST_CHECK_EQUAL( reinterpret_cast<size_t>(m.get()) % 64, 0 );
+		fill_pattern(m, 7, 3, 11, -5);
+		m.flush();
+	}
+	const mmap_matrix<const T> m(file.path);
+	BOOST_REQUIRE_EQUAL( m.width(), 37 );
+	BOOST_REQUIRE_EQUAL( m.height(), 23 );
+	m.advise(advise_sequential);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			BOOST_CHECK_EQUAL( m(x, y), T(int(x * 7 + y * 3) % 11 - 5) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( ReadWrite, T, test_types )
+{
+	temp_file file;
+	{
+		mmap_matrix<T> m(file.path, 8, 4);
+		fill_pattern(m, 7, 3, 11, -5);
+	}
+	{
+		mmap_matrix<T> m(file.path);
+		m(3, 2) = T(42);
+	}
+	mmap_matrix<const T> m(file.path);
+	BOOST_CHECK_EQUAL( m(3, 2), T(42) );
+	BOOST_CHECK_EQUAL( m(2, 3), T(int(2 * 7 + 3 * 3) % 11 - 5) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Composes, T, test_types )
+{
+	temp_file file;
+	mmap_matrix<T> m(file.path, 40, 30);
+	fill_pattern(m, 7, 3, 11, -5);
+	m.advise(advise_random, 5, 10);
+
+	auto_matrix<T> reference(40, 30);
+	copy_matrix(m, reference);
+
+	auto_matrix<T> roi(12, 10), expected(12, 10);
+	copy_matrix(limit(offset(m, 7, 5), 12, 10), roi);
+	copy_matrix(limit(offset(reference, 7, 5), 12, 10), expected);
+	for (size_t y = 0; y < roi.height(); ++y)
+		for (size_t x = 0; x < roi.width(); ++x)
+			BOOST_CHECK_EQUAL( roi(x, y), expected(x, y) );
+
+	weak_matrix<T> view = m;
+	BOOST_CHECK_EQUAL( view.get(), m.get() );
+
+	auto_matrix<T> kernel(3, 3, T(1));
+	auto_matrix<T> a(40, 30), b(40, 30);
+	copy_matrix(convolve(m, kernel, 1, 1), a);
+	copy_matrix(convolve(reference, kernel, 1, 1), b);
+	for (size_t y = 0; y < a.height(); ++y)
+		for (size_t x = 0; x < a.width(); ++x)
+			BOOST_CHECK_EQUAL( a(x, y), b(x, y) );
+}
+
+BOOST_AUTO_TEST_CASE( HeaderMismatch )
+{
+	temp_file file;
+	{
+		mmap_matrix<double> m(file.path, 4, 4);
+	}
+	BOOST_CHECK_THROW( mmap_matrix<const int> m(file.path), std::runtime_error );
+	BOOST_CHECK_THROW( mmap_matrix<const float> m(file.path), std::runtime_error );
+	BOOST_CHECK_THROW( mmap_matrix<const double> m(file.path + ".missing"), std::runtime_error );
+	{
+		std::FILE* f = std::fopen(file.path.c_str(), "r+b");
+		BOOST_REQUIRE( f );
+		BOOST_REQUIRE_EQUAL( ::ftruncate(::fileno(f), 80), 0 );
+		std::fclose(f);
+	}
+	BOOST_CHECK_THROW( mmap_matrix<const double> m(file.path), std::runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE( HeaderOverflow )
+{
+	temp_file file;
+	{
+		mmap_matrix<double> m(file.path, 4, 4);
+	}
+	BOOST_CHECK_NO_THROW( mmap_matrix<const double> m(file.path) );
+	const uint64_t huge = uint64_t(1) << 62;
+	patch_header(file.path, offsetof(matrix_file_header, pitch), huge);
+	patch_header(file.path, offsetof(matrix_file_header, height), 5);
+	BOOST_CHECK_THROW( mmap_matrix<const double> m(file.path), std::runtime_error );
+	patch_header(file.path, offsetof(matrix_file_header, pitch), 4);
+	patch_header(file.path, offsetof(matrix_file_header, height), 4);
+	patch_header(file.path, offsetof(matrix_file_header, data_offset), ~uint64_t(0) - 64);
+	BOOST_CHECK_THROW( mmap_matrix<const double> m(file.path), std::runtime_error );
+	patch_header(file.path, offsetof(matrix_file_header, data_offset), 68);
+	BOOST_CHECK_THROW( mmap_matrix<const double> m(file.path), std::runtime_error );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -20,7 +20,9 @@
 #include <boost/test/test_case_template.hpp>
 #include <boost/mpl/list.hpp>
 #include <complex>
+#include <type_traits>
 
+#include <nmpp/auto_matrix.hpp>
 #include <nmpp/weak_matrix.hpp>
 #include <nmpp/sub_matrix.hpp>
 
@@ -39,4 +41,60 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( CreateIgnore, T, test_types )
 	BOOST_CHECK_EQUAL( offset(m, 1, 0)(0, 1), T(97) );
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( ReadRow, T, test_types )
+{
+	T a[] = { T(3), T(23), T(17), T(11), T(51), T(97), T(397), T(511) };
+	weak_matrix<T> m(a, 4, 2);
+	T row[2];
+	offset(m, 1, 1).read_row(1, 0, 2, row);
+	BOOST_CHECK_EQUAL( row[0], T(397) );
+	BOOST_CHECK_EQUAL( row[1], T(511) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( AssignCopies, T, test_types )
+{
+	auto_matrix<T> dst(3, 3, T(0));
+	T a[] = { T(4), T(5), T(6), T(7) };
+	weak_matrix<T> src(a, 2, 2);
+	offset(dst, 1, 1) = src;
+	BOOST_CHECK_EQUAL( dst(0, 0), T(0) );
+	BOOST_CHECK_EQUAL( dst(1, 1), T(4) );
+	BOOST_CHECK_EQUAL( dst(2, 2), T(7) );
+
+	auto_matrix<T> other(2, 2, T(9));
+	offset(dst, 0, 0) = limit(other, 1, 1);
+	BOOST_CHECK_EQUAL( dst(0, 0), T(9) );
+
+	weak_matrix<T> view(dst);
+	offset(view, 1, 0) = other;
+	BOOST_CHECK_EQUAL( dst(1, 0), T(9) );
+	BOOST_CHECK_EQUAL( dst(2, 1), T(9) );
+	BOOST_CHECK_EQUAL( dst(2, 2), T(7) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( ConstStaysConst, T, test_types )
+{
+	const auto_matrix<T> m(4, 3, T(1));
+	const weak_matrix<T> view(m);
+	BOOST_CHECK(( std::is_same<decltype(offset(m, 1, 1).get()), const T*>::value ));
+	BOOST_CHECK(( std::is_same<decltype(offset(view, 1, 1).get()), const T*>::value ));
+	BOOST_CHECK(( std::is_same<decltype(limit(offset(view, 1, 1), 2, 2).get()), const T*>::value ));
+	BOOST_CHECK_EQUAL( offset(view, 1, 1)(2, 1), T(1) );
+	const weak_matrix<const T> const_view(m.get(), m.width(), m.height());
+	BOOST_CHECK(( std::is_same<decltype(offset(const_view, 1, 1).get()), const T*>::value ));
+	BOOST_CHECK_EQUAL( limit(const_view, 2, 2)(1, 1), T(1) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( RegionAccessors, T, test_types )
+{
+	auto_matrix<T> m(5, 4, T(0));
+	weak_matrix<T> view(m);
+	BOOST_CHECK_EQUAL( offset(view, 2, 1).offset_x(), 2 );
+	BOOST_CHECK_EQUAL( offset(view, 2, 1).offset_y(), 1 );
+	BOOST_CHECK_EQUAL( offset(view, 2, 1).matrix().get(), m.get() );
+	BOOST_CHECK_EQUAL( offset(offset(m, 1, 1), 1, 2).matrix().get(), &m(1, 1) );
+	BOOST_CHECK_EQUAL( limit(m, 3, 2).offset_x(), 0 );
+	BOOST_CHECK_EQUAL( limit(m, 3, 2).matrix().width(), 5 );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -22,6 +22,7 @@
 #include <complex>
 
 #include <nmpp/weak_matrix.hpp>
+#include <nmpp/auto_matrix.hpp>
 #include <nmpp/operators.hpp>
 
 using namespace nmpp;
@@ -82,4 +83,22 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( Divide, T, test_types )
 	BOOST_CHECK_EQUAL( mdiv(m1, m2).height(), m1.height() );
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( NestedCopy, T, test_types )
+{
+	T a1[] = { T(3), T(23), T(5), T(7) };
+	T a2[] = { T(17), T(11), T(2), T(13) };
+	weak_matrix<T> m1(a1, 2, 2);
+	weak_matrix<T> m2(a2, 2, 2);
+	auto_matrix<T> result(2, 2);
+	mplus(mmul(m1, m2), splus(m1, T(1)), result);
+	for (size_t y = 0; y < 2; ++y)
+		for (size_t x = 0; x < 2; ++x)
+			BOOST_CHECK_EQUAL( result(x, y), m1(x, y)*m2(x, y) + m1(x, y) + T(1) );
+	weak_matrix<T> weak_result(result);
+	copy_matrix(mminus(m2, m1), weak_result);
+	for (size_t y = 0; y < 2; ++y)
+		for (size_t x = 0; x < 2; ++x)
+			BOOST_CHECK_EQUAL( result(x, y), m2(x, y) - m1(x, y) );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
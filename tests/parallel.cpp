@@ -0,0 +1,142 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <complex>
+#include <vector>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/operators.hpp>
+#include <nmpp/convolution.hpp>
+#include <nmpp/matmul.hpp>
+#include <nmpp/parallel.hpp>
+#include <nmpp/parallel_algorithms.hpp>
+
+using namespace nmpp;
+
+typedef boost::mpl::list< double, int, std::complex<float> > test_types;
+
+BOOST_AUTO_TEST_SUITE( Parallel )
+
+BOOST_AUTO_TEST_CASE( RunsEveryTaskOnce )
+{
+	thread_pool pool(4);
+	BOOST_CHECK_EQUAL( pool.size(), 4 );
+	std::vector<int> counts(100, 0);
+	pool.run(counts.size(), [&](size_t i) { ++counts[i]; });
+	for (size_t i = 0; i < counts.size(); ++i)
+		BOOST_CHECK_EQUAL( counts[i], 1 );
+}
+
+BOOST_AUTO_TEST_CASE( NestedRun )
+{
+	thread_pool pool(3);
+	std::vector<int> counts(16, 0);
+	pool.run(4, [&](size_t i) {
+		pool.run(4, [&](size_t j) { ++counts[i * 4 + j]; });
+	});
+	for (size_t i = 0; i < counts.size(); ++i)
+		BOOST_CHECK_EQUAL( counts[i], 1 );
+}
+
+BOOST_AUTO_TEST_CASE( PropagatesException )
+{
+	thread_pool pool(2);
+	BOOST_CHECK_THROW( pool.run(8, [](size_t i) { if (i == 5) throw std::exception(); }), std::exception );
+	int total = 0;
+	pool.run(1, [&](size_t) { ++total; });
+	BOOST_CHECK_EQUAL( total, 1 );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( CopyMatrix, T, test_types )
+{
+	T k[] = { T(1), T(0), T(-1), T(2), T(1), T(3) };
+	weak_matrix<T> kernel(k, 3, 2);
+	auto_matrix<T> a(37, 29);
+	for (size_t y = 0; y < a.height(); ++y)
+		for (size_t x = 0; x < a.width(); ++x)
+			a(x, y) = T(int(x * 7 + y * 3) % 17);
+	auto_matrix<T> expected(37, 29), result(37, 29);
+	copy_matrix(mplus(convolve(a, kernel, 1, 1), a), expected);
+	copy_matrix(mplus(convolve(a, kernel, 1, 1), a), result, par);
+	for (size_t y = 0; y < a.height(); ++y)
+		for (size_t x = 0; x < a.width(); ++x)
+			BOOST_CHECK_EQUAL( result(x, y), expected(x, y) );
+}
+
+BOOST_AUTO_TEST_CASE( DeterministicSum )
+{
+	auto_matrix<double> m(1000, 700);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			m(x, y) = 1.0 / double(1 + (x * 31 + y * 17) % 1009);
+	const double expected = sum(m);
+	BOOST_CHECK_EQUAL( sum(m, par), expected );
+	BOOST_CHECK_EQUAL( sum(m, seq), expected );
+	BOOST_CHECK_EQUAL( sum(mmul(m, m), par), sum(mmul(m, m)) );
+	BOOST_CHECK_EQUAL( norm2(m, par), norm2(m) );
+	BOOST_CHECK_EQUAL( dot(m, m, par), dot(m, m) );
+	BOOST_CHECK_EQUAL( mean(m, par), mean(m) );
+	auto_matrix<int> counts(3, 1, 1);
+	counts(0, 0) = 2;
+	BOOST_CHECK_EQUAL( mean(counts, par), mean(counts) );
+}
+
+BOOST_AUTO_TEST_CASE( WideParallelDot )
+{
+	auto_matrix<unsigned char> a(512, 512, 255);
+	BOOST_CHECK_EQUAL( dot(a, a, par), 17045913600ul );
+	auto_matrix<short> b(512, 512, 300);
+	BOOST_CHECK_EQUAL( dot(b, b, par), 23592960000l );
+}
+
+BOOST_AUTO_TEST_CASE( ParallelExtrema )
+{
+	auto_matrix<int> m(600, 500, 0);
+	m(599, 0) = 7;
+	m(3, 420) = 9;
+	m(200, 499) = 9;
+	m(13, 300) = -4;
+	BOOST_CHECK_EQUAL( max(m, par), 9 );
+	BOOST_CHECK_EQUAL( min(m, par), -4 );
+	BOOST_CHECK_EQUAL( minmax(m, par).first, -4 );
+	BOOST_CHECK_EQUAL( minmax(m, par).second, 9 );
+	BOOST_CHECK_EQUAL( argmax(m, par).first, 3 );
+	BOOST_CHECK_EQUAL( argmax(m, par).second, 420 );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Matmul, T, test_types )
+{
+	auto_matrix<T> a(150, 300), b(70, 150), c(70, 300), expected(70, 300);
+	for (size_t y = 0; y < a.height(); ++y)
+		for (size_t x = 0; x < a.width(); ++x)
+			a(x, y) = T(int(x * 3 + y * 5) % 7 - 3);
+	for (size_t y = 0; y < b.height(); ++y)
+		for (size_t x = 0; x < b.width(); ++x)
+			b(x, y) = T(int(x * 2 + y * 3) % 5 - 2);
+	matmul(a, b, expected);
+	matmul(a, b, c, par);
+	for (size_t y = 0; y < c.height(); ++y)
+		for (size_t x = 0; x < c.width(); ++x)
+			BOOST_CHECK_EQUAL( c(x, y), expected(x, y) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,146 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <complex>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/operators.hpp>
+#include <nmpp/uniform_matrix.hpp>
+#include <nmpp/reduction.hpp>
+
+#include "test_helpers.hpp"
+
+using namespace nmpp;
+
+typedef boost::mpl::list< double, int, std::complex<float> > test_types;
+typedef boost::mpl::list< double, int > ordered_types;
+
+BOOST_AUTO_TEST_SUITE( Reduction )
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Sum, T, test_types )
+{
+	auto_matrix<T> m(301, 7);
+	fill_pattern(m, 3, 5, 19, -9);
+	T expected = T(0);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			expected += m(x, y);
+	BOOST_CHECK_EQUAL( T(sum(m)), expected );
+	BOOST_CHECK_EQUAL( T(sum(auto_matrix<T>())), T(0) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( SumExpression, T, test_types )
+{
+	auto_matrix<T> a(300, 80), b(300, 80);
+	fill_pattern(a, 3, 5, 19, -9);
+	fill_pattern(b, 7, 2, 19, -9);
+	T expected = T(0);
+	for (size_t y = 0; y < a.height(); ++y)
+		for (size_t x = 0; x < a.width(); ++x)
+			expected += a(x, y) - b(x, y);
+	BOOST_CHECK_EQUAL( T(sum(mminus(a, b))), expected );
+	BOOST_CHECK_EQUAL( T(mean(mminus(a, a))), T(0) );
+}
+
+BOOST_AUTO_TEST_CASE( Mean )
+{
+	auto_matrix<double> m(4, 2, 1.5);
+	m(3, 1) = 5.5;
+	BOOST_CHECK_EQUAL( mean(m), 2.0 );
+}
+
+BOOST_AUTO_TEST_CASE( IntegerMean )
+{
+	auto_matrix<int> m(2, 2, 1);
+	m(1, 1) = 2;
+	BOOST_CHECK_EQUAL( mean(m), 1.25 );
+	auto_matrix<unsigned char> c(3, 1, 1);
+	c(0, 0) = 2;
+	BOOST_CHECK_CLOSE( mean(c), 4.0 / 3.0, 1e-12 );
+	auto_matrix< std::complex<int> > z(2, 1, std::complex<int>(1, 3));
+	z(0, 0) = std::complex<int>(2, 0);
+	BOOST_CHECK_EQUAL( mean(z), std::complex<double>(1.5, 1.5) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Extrema, T, ordered_types )
+{
+	auto_matrix<T> m(37, 23);
+	fill_pattern(m, 3, 5, 19, -9);
+	m(17, 11) = T(100);
+	m(30, 20) = T(100);
+	m(5, 2) = T(-100);
+	BOOST_CHECK_EQUAL( max(m), T(100) );
+	BOOST_CHECK_EQUAL( min(m), T(-100) );
+	BOOST_CHECK_EQUAL( minmax(m).first, T(-100) );
+	BOOST_CHECK_EQUAL( minmax(m).second, T(100) );
+	BOOST_CHECK_EQUAL( argmax(m).first, 17 );
+	BOOST_CHECK_EQUAL( argmax(m).second, 11 );
+	BOOST_CHECK_EQUAL( max(mmul(m, m)), T(10000) );
+	BOOST_CHECK_EQUAL( argmax(mmul(m, uniform(T(-1)))).first, 5 );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( DotAndNorm, T, test_types )
+{
+	auto_matrix<T> a(50, 9), b(50, 9);
+	fill_pattern(a, 3, 5, 19, -9);
+	fill_pattern(b, 7, 2, 19, -9);
+	T expected_dot = T(0);
+	double expected_norm = 0;
+	for (size_t y = 0; y < a.height(); ++y) {
+		for (size_t x = 0; x < a.width(); ++x) {
+			expected_dot += a(x, y) * b(x, y);
+			expected_norm += std::abs(a(x, y)) * std::abs(a(x, y));
+		}
+	}
+	BOOST_CHECK_EQUAL( T(dot(a, b)), expected_dot );
+	BOOST_CHECK_CLOSE( double(norm2(a)), std::sqrt(expected_norm), 1e-4 );
+}
+
+BOOST_AUTO_TEST_CASE( ComplexDotConjugates )
+{
+	typedef std::complex<float> C;
+	auto_matrix<C> a(2, 1), b(2, 1);
+	a(0, 0) = C(1, 2);
+	a(1, 0) = C(0, -3);
+	b(0, 0) = C(3, 1);
+	b(1, 0) = C(2, 2);
+	// conj(1+2i)(3+i) + conj(-3i)(2+2i) = (5-5i) + (-6+6i)
+	BOOST_CHECK_EQUAL( dot(a, b), std::complex<double>(-1, 1) );
+	BOOST_CHECK_EQUAL( dot(a, a), std::complex<double>(14, 0) );
+	BOOST_CHECK_CLOSE( std::sqrt(dot(a, a).real()), double(norm2(a)), 1e-6 );
+}
+
+BOOST_AUTO_TEST_CASE( WideSum )
+{
+	auto_matrix<unsigned char> m(100, 100, 200);
+	BOOST_CHECK_EQUAL( sum(m), 2000000u );
+}
+
+BOOST_AUTO_TEST_CASE( WideDot )
+{
+	auto_matrix<unsigned char> a(512, 512, 255);
+	BOOST_CHECK_EQUAL( dot(a, a), 17045913600ul );
+	auto_matrix<short> b(512, 512, 300);
+	BOOST_CHECK_EQUAL( dot(b, b), 23592960000l );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,114 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <complex>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/sub_matrix.hpp>
+#include <nmpp/static_matrix.hpp>
+#include <nmpp/convolution.hpp>
+
+#include "test_helpers.hpp"
+
+using namespace nmpp;
+
+typedef boost::mpl::list< double, int, std::complex<float> > test_types;
+
+namespace {
+
+template<class T, size_t W, size_t H>
+void check_convolve(size_t width, size_t height, size_t anchor_x, size_t anchor_y)
+{
+	auto_matrix<T> input(width, height), dynamic_kernel(W, H);
+	static_matrix<T, W, H> kernel;
+	fill_pattern(input, 7, 3, 11, -5, 0);
+	fill_pattern(kernel, 7, 3, 11, -5, 4);
+	copy_matrix(kernel, dynamic_kernel);
+
+	auto_matrix<T> expected(width, height), rows(width, height);
+	copy_matrix(convolve(input, dynamic_kernel, anchor_x, anchor_y), expected);
+	copy_matrix(convolve(input, kernel, anchor_x, anchor_y), rows);
+	const detail::convolve_op<auto_matrix<T>, static_matrix<T, W, H> > op(input, kernel, anchor_x, anchor_y);
+	for (size_t y = 0; y < height; ++y) {
+		for (size_t x = 0; x < width; ++x) {
+			BOOST_CHECK_EQUAL( rows(x, y), expected(x, y) );
+			BOOST_CHECK_EQUAL( op(x, y), expected(x, y) );
+		}
+	}
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( StaticMatrix )
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Concept, T, test_types )
+{
+	static_matrix<T, 4, 3> m(T(2));
+	BOOST_CHECK_EQUAL( m.width(), 4 );
+	BOOST_CHECK_EQUAL( m.height(), 3 );
+	BOOST_CHECK_EQUAL( (static_matrix<T, 4, 3>::static_width), 4 );
+	BOOST_CHECK_EQUAL( m(3, 2), T(2) );
+	fill_pattern(m, 7, 3, 11, -5, 1);
+
+	const T values[] = { T(1), T(2), T(3), T(4), T(5), T(6) };
+	const static_matrix<T, 3, 2> v(values);
+	BOOST_CHECK_EQUAL( v(0, 1), T(4) );
+	BOOST_CHECK_EQUAL( v(2, 1), T(6) );
+
+	auto_matrix<T> copy(4, 3);
+	copy_matrix(m, copy);
+	for (size_t y = 0; y < 3; ++y)
+		for (size_t x = 0; x < 4; ++x)
+			BOOST_CHECK_EQUAL( copy(x, y), m(x, y) );
+
+	auto_matrix<T> window(2, 2);
+	copy_matrix(limit(offset(weak_matrix<T>(m), 1, 1), 2, 2), window);
+	BOOST_CHECK_EQUAL( window(1, 1), m(2, 2) );
+
+	static_matrix<T, 4, 3> assigned;
+	assigned = copy;
+	BOOST_CHECK_EQUAL( assigned(3, 2), m(3, 2) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( ConvolveUnrolled, T, test_types )
+{
+	check_convolve<T, 3, 3>(23, 17, 1, 1);
+	check_convolve<T, 5, 5>(23, 17, 2, 2);
+	check_convolve<T, 3, 1>(23, 17, 0, 0);
+	check_convolve<T, 4, 2>(5, 3, 3, 1);
+	check_convolve<T, 3, 3>(300, 4, 1, 1);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( ConvolveMaterialized, T, test_types )
+{
+	auto_matrix<T> input(31, 19), expected(31, 19), result(31, 19);
+	static_matrix<T, 5, 5> kernel;
+	fill_pattern(input, 7, 3, 11, -5, 2);
+	fill_pattern(kernel, 7, 3, 11, -5, 7);
+	copy_matrix(convolve(input, kernel, 2, 2), expected);
+	convolve(input, kernel, 2, 2, result);
+	for (size_t y = 0; y < 19; ++y)
+		for (size_t x = 0; x < 31; ++x)
+			BOOST_CHECK_EQUAL( result(x, y), expected(x, y) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
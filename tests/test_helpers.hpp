@@ -0,0 +1,73 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_TESTS_TEST_HELPERS_HPP
+#define NMPP_TESTS_TEST_HELPERS_HPP
+
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * Fill a matrix with the small integer pattern
+ * (x * a + y * b + seed) % modulus + bias, which every test type holds
+ * exactly.
+ */
+template<class MatrixT>
+void fill_pattern(MatrixT& m, int a, int b, int modulus, int bias, int seed = 0)
+{
+	typedef typename MatrixT::value_type value_type;
+	for (std::size_t y = 0; y < m.height(); ++y)
+		for (std::size_t x = 0; x < m.width(); ++x)
+			m(x, y) = value_type(int(x * a + y * b + seed) % modulus + bias);
+}
+
+/**
+ * Check that two matrices have the same size and elements.
+ */
+template<class ResultT, class ExpectedT>
+void check_equal(const ResultT& result, const ExpectedT& expected)
+{
+	BOOST_REQUIRE_EQUAL( result.width(), expected.width() );
+	BOOST_REQUIRE_EQUAL( result.height(), expected.height() );
+	for (std::size_t y = 0; y < result.height(); ++y)
+		for (std::size_t x = 0; x < result.width(); ++x)
+			BOOST_CHECK_EQUAL( result(x, y), expected(x, y) );
+}
+
+/**
+ * A uniquely named empty file in /tmp, removed again on destruction.
+ */
+struct temp_file
+{
+	temp_file() {
+		char name[] = "/tmp/nmpp_test_XXXXXX";
+		const int fd = ::mkstemp(name);
+		BOOST_REQUIRE( fd >= 0 );
+		::close(fd);
+		path = name;
+	}
+	~temp_file() { std::remove(path.c_str()); }
+
+	std::string path;
+};
+
+#endif // NMPP_TESTS_TEST_HELPERS_HPP
@@ -0,0 +1,85 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/mpl/list.hpp>
+#include <complex>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/sub_matrix.hpp>
+#include <nmpp/operators.hpp>
+#include <nmpp/convolution.hpp>
+#include <nmpp/tiled.hpp>
+
+#include "test_helpers.hpp"
+
+using namespace nmpp;
+
+typedef boost::mpl::list< double, int, std::complex<float> > test_types;
+
+namespace {
+
+template<class T, class InputT>
+void check_tiled(const InputT& input, const tiled_policy& policy)
+{
+	auto_matrix<T> expected(input.width(), input.height()), result(input.width(), input.height());
+	copy_matrix(input, expected);
+	copy_matrix(input, result, policy);
+	check_equal(result, expected);
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( Tiled )
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( ChainedStencils, T, test_types )
+{
+	T k1[] = { T(1), T(2), T(1), T(0), T(-1), T(0) };
+	T k2[] = { T(2), T(-1), T(1), T(1), T(0), T(3), T(-2), T(1), T(1) };
+	weak_matrix<T> kernel1(k1, 3, 2), kernel2(k2, 3, 3);
+	auto_matrix<T> m(41, 29);
+	fill_pattern(m, 7, 3, 11, -5);
+	check_tiled<T>(convolve(convolve(m, kernel1, 1, 0), kernel2, 2, 2), tiled_policy(7, 5));
+	check_tiled<T>(convolve(convolve(m, kernel1, 0, 1), kernel2, 0, 0), tiled_policy(16, 3));
+	check_tiled<T>(convolve(convolve(convolve(m, kernel2, 1, 1), kernel1, 2, 1), kernel2, 1, 0), tiled_policy(10, 10));
+	check_tiled<T>(convolve(convolve(m, kernel1, 1, 0), kernel2, 2, 2), tiled);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( MixedExpression, T, test_types )
+{
+	T k[] = { T(1), T(2), T(1), T(0), T(-1), T(0), T(1), T(0), T(2) };
+	weak_matrix<T> kernel(k, 3, 3);
+	auto_matrix<T> a(37, 23), b(40, 26);
+	fill_pattern(a, 7, 3, 11, -5);
+	fill_pattern(b, 7, 3, 11, -5);
+	check_tiled<T>(mplus(convolve(mmul(a, a), kernel, 1, 1), offset(b, 2, 3)), tiled_policy(8, 8));
+	check_tiled<T>(convolve(mminus(convolve(a, kernel, 0, 2), a), kernel, 2, 0), tiled_policy(5, 9));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( TileLargerThanImage, T, test_types )
+{
+	T k[] = { T(1), T(1), T(1), T(1) };
+	weak_matrix<T> kernel(k, 2, 2);
+	auto_matrix<T> m(3, 2);
+	fill_pattern(m, 7, 3, 11, -5);
+	check_tiled<T>(convolve(convolve(m, kernel, 1, 1), kernel, 0, 0), tiled_policy(64, 64));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
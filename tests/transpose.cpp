@@ -21,7 +21,9 @@
 #include <boost/mpl/list.hpp>
 #include <complex>
 
+#include <nmpp/auto_matrix.hpp>
 #include <nmpp/weak_matrix.hpp>
+#include <nmpp/operators.hpp>
 #include <nmpp/transpose.hpp>
 
 using namespace nmpp;
@@ -42,4 +44,55 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( CreateAndCheck, T, test_types )
 	BOOST_CHECK_EQUAL( transpose(m).height(), m.width() );
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( Materialize, T, test_types )
+{
+	auto_matrix<T> m(70, 45);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			m(x, y) = T(y * 100 + x);
+	auto_matrix<T> t(45, 70);
+	transpose(m, t);
+	for (size_t y = 0; y < t.height(); ++y)
+		for (size_t x = 0; x < t.width(); ++x)
+			BOOST_CHECK_EQUAL( t(x, y), m(y, x) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( MaterializeStrided, T, test_types )
+{
+	T a[] = { T(1), T(2), T(3), T(0), T(4), T(5), T(6), T(0) };
+	weak_matrix<T> m(a, 3, 2, 4);
+	T b[2*3];
+	weak_matrix<T> t(b, 2, 3);
+	transpose(m, t);
+	BOOST_CHECK_EQUAL( t(0, 0), T(1) );
+	BOOST_CHECK_EQUAL( t(1, 0), T(4) );
+	BOOST_CHECK_EQUAL( t(0, 2), T(3) );
+	BOOST_CHECK_EQUAL( t(1, 2), T(6) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( MaterializeExpression, T, test_types )
+{
+	auto_matrix<T> m(40, 33);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			m(x, y) = T(y * 50 + x);
+	auto_matrix<T> t(33, 40);
+	transpose(mplus(m, m), t);
+	for (size_t y = 0; y < t.height(); ++y)
+		for (size_t x = 0; x < t.width(); ++x)
+			BOOST_CHECK_EQUAL( t(x, y), m(y, x) + m(y, x) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( InPlace, T, test_types )
+{
+	auto_matrix<T> m(67, 67);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			m(x, y) = T(y * 100 + x);
+	transpose_inplace(m);
+	for (size_t y = 0; y < m.height(); ++y)
+		for (size_t x = 0; x < m.width(); ++x)
+			BOOST_CHECK_EQUAL( m(x, y), T(x * 100 + y) );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
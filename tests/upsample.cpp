@@ -0,0 +1,173 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/mpl/list.hpp>
+#include <cmath>
+#include <complex>
+
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/weak_matrix.hpp>
+#include <nmpp/operators.hpp>
+#include <nmpp/sub_matrix.hpp>
+#include <nmpp/transpose.hpp>
+#include <nmpp/upsample.hpp>
+
+using namespace nmpp;
+
+typedef boost::mpl::list< double, int, std::complex<float> > test_types;
+typedef boost::mpl::list< unsigned char, unsigned short > fixed_types;
+
+namespace {
+
+double reference(const auto_matrix<double>& input, size_t width, size_t height, size_t x, size_t y)
+{
+	const double fx = width > 1 ? double(x) * (input.width() - 1) / (width - 1) : 0;
+	const double fy = height > 1 ? double(y) * (input.height() - 1) / (height - 1) : 0;
+	const size_t x0 = size_t(fx), y0 = size_t(fy);
+	const size_t x1 = std::min(x0 + 1, input.width() - 1), y1 = std::min(y0 + 1, input.height() - 1);
+	const double dx = fx - x0, dy = fy - y0;
+	return (1 - dy) * ((1 - dx) * input(x0, y0) + dx * input(x1, y0))
+		+ dy * ((1 - dx) * input(x0, y1) + dx * input(x1, y1));
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( Upsample )
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( NearestReplicates, T, test_types )
+{
+	T a[] = { T(1), T(2), T(3), T(4) };
+	weak_matrix<T> m(a, 2, 2);
+	auto_matrix<T> out(4, 4);
+	upsample_nearest(m, out);
+	BOOST_CHECK_EQUAL( out(0, 0), T(1) );
+	BOOST_CHECK_EQUAL( out(1, 1), T(1) );
+	BOOST_CHECK_EQUAL( out(2, 0), T(2) );
+	BOOST_CHECK_EQUAL( out(3, 3), T(4) );
+	BOOST_CHECK_EQUAL( out(0, 3), T(3) );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( BilinearMidpoints, T, test_types )
+{
+	T a[] = { T(0), T(4), T(8), T(12) };
+	weak_matrix<T> m(a, 2, 2);
+	auto_matrix<T> out(3, 3);
+	upsample_bilinear(m, out);
+	BOOST_CHECK_EQUAL( out(0, 0), T(0) );
+	BOOST_CHECK_EQUAL( out(2, 0), T(4) );
+	BOOST_CHECK_EQUAL( out(0, 2), T(8) );
+	BOOST_CHECK_EQUAL( out(2, 2), T(12) );
+	BOOST_CHECK_EQUAL( out(1, 0), T(2) );
+	BOOST_CHECK_EQUAL( out(0, 1), T(4) );
+	BOOST_CHECK_EQUAL( out(1, 1), T(6) );
+}
+
+BOOST_AUTO_TEST_CASE( BilinearMatchesReference )
+{
+	auto_matrix<double> input(37, 23);
+	for (size_t y = 0; y < input.height(); ++y)
+		for (size_t x = 0; x < input.width(); ++x)
+			input(x, y) = double((x * 13 + y * 7) % 31);
+	auto_matrix<double> output(1001, 67);
+	upsample_bilinear(input, output);
+	for (size_t y = 0; y < output.height(); ++y)
+		for (size_t x = 0; x < output.width(); ++x)
+			BOOST_REQUIRE_SMALL( output(x, y) - reference(input, output.width(), output.height(), x, y), 1e-9 );
+}
+
+BOOST_AUTO_TEST_CASE( BilinearNoDriftOnWideRows )
+{
+	auto_matrix<float> input(1920, 1);
+	for (size_t x = 0; x < input.width(); ++x)
+		input(x, 0) = float(x);
+	auto_matrix<float> output(3840, 1);
+	upsample_bilinear(input, output);
+	BOOST_CHECK_EQUAL( output(0, 0), 0.0f );
+	BOOST_CHECK_EQUAL( output(3839, 0), 1919.0f );
+	for (size_t x = 0; x < output.width(); ++x)
+		BOOST_REQUIRE_SMALL( output(x, 0) - float(double(x) * 1919 / 3839), 1e-3f );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( BilinearFixedPointRounds, T, fixed_types )
+{
+	const double peak = std::numeric_limits<T>::max();
+	auto_matrix<double> reference_input(19, 11);
+	auto_matrix<T> input(19, 11);
+	for (size_t y = 0; y < input.height(); ++y) {
+		for (size_t x = 0; x < input.width(); ++x) {
+			input(x, y) = T(std::fmod((x * 97.0 + y * 61.0) * peak / 211.0, peak + 1));
+			reference_input(x, y) = input(x, y);
+		}
+	}
+	auto_matrix<T> output(64, 40);
+	upsample_bilinear(input, output);
+	BOOST_CHECK_EQUAL( output(0, 0), input(0, 0) );
+	BOOST_CHECK_EQUAL( output(63, 39), input(18, 10) );
+	const double tolerance = 0.5 + peak / (sizeof(T) == 1 ? 2048.0 : 256.0);
+	for (size_t y = 0; y < output.height(); ++y)
+		for (size_t x = 0; x < output.width(); ++x)
+			BOOST_REQUIRE_SMALL( double(output(x, y)) - reference(reference_input, 64, 40, x, y), tolerance );
+}
+
+BOOST_AUTO_TEST_CASE( BilinearFixedPointSaturatedInput )
+{
+	auto_matrix<unsigned short> input(5, 5, 65535);
+	auto_matrix<unsigned short> output(17, 13);
+	upsample_bilinear(input, output);
+	for (size_t y = 0; y < output.height(); ++y)
+		for (size_t x = 0; x < output.width(); ++x)
+			BOOST_REQUIRE_EQUAL( output(x, y), 65535 );
+}
+
+BOOST_AUTO_TEST_CASE( BilinearExpressionAndGenericOutput )
+{
+	auto_matrix<float> input(4, 3);
+	for (size_t y = 0; y < input.height(); ++y)
+		for (size_t x = 0; x < input.width(); ++x)
+			input(x, y) = float(x + 10 * y);
+	auto_matrix<float> output(7, 5);
+	upsample_bilinear(input, output);
+	auto_matrix<float> transposed(5, 7);
+	upsample_bilinear(transpose(input), transposed);
+	auto_matrix<float> padded(8, 6, -1.0f);
+	detail::offset_op< auto_matrix<float> > view(padded, 1, 1);
+	upsample_bilinear(input, view);
+	BOOST_CHECK_EQUAL( padded(0, 0), -1.0f );
+	for (size_t y = 0; y < output.height(); ++y) {
+		for (size_t x = 0; x < output.width(); ++x) {
+			BOOST_CHECK_CLOSE( transposed(y, x) + 1, output(x, y) + 1, 1e-4 );
+			BOOST_CHECK_EQUAL( padded(x + 1, y + 1), output(x, y) );
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( BilinearSingleColumn )
+{
+	float a[] = { 2, 6 };
+	weak_matrix<float> m(a, 1, 2);
+	auto_matrix<float> out(1, 3);
+	upsample_bilinear(m, out);
+	BOOST_CHECK_EQUAL( out(0, 0), 2.0f );
+	BOOST_CHECK_EQUAL( out(0, 1), 4.0f );
+	BOOST_CHECK_EQUAL( out(0, 2), 6.0f );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -47,6 +47,18 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( InitCtor, T, test_types )
 	BOOST_CHECK_EQUAL( m.get(), a );
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( PitchCtor, T, test_types )
+{
+	T a[] = { T(11), T(15), T(51), T(3), T(29), T(3491) };
+	weak_matrix<T> m(a, 2, 2, 3);
+	BOOST_CHECK_EQUAL( m.width(), 2 );
+	BOOST_CHECK_EQUAL( m.height(), 2 );
+	BOOST_CHECK_EQUAL( m.pitch(), 3 );
+	BOOST_CHECK_EQUAL( m(1, 0), T(15) );
+	BOOST_CHECK_EQUAL( m(0, 1), T(3) );
+	BOOST_CHECK_EQUAL( m(1, 1), T(29) );
+}
+
 BOOST_AUTO_TEST_CASE_TEMPLATE( AutoMatrixCtor, T, test_types )
 {
 	auto_matrix<T> am(11, 5);
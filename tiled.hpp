@@ -0,0 +1,202 @@
+/*  Copyright 2010 Mark Nevill
+ *
+ *  This file is part of NMPP.
+ *
+ *  NMPP is free software: you can redistribute it and/or modify it under the
+ *  terms of the GNU Lesser General Public License as published by the Free
+ *  Software Foundation, either version 3 of the License, or (at your option)
+ *  any later version.
+ *
+ *  Foobar is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ *  more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with NMPP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMPP_TILED_HPP
+#define NMPP_TILED_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <nmpp/util.hpp>
+#include <nmpp/auto_matrix.hpp>
+#include <nmpp/operators.hpp>
+#include <nmpp/convolution.hpp>
+#include <nmpp/memory_pool.hpp>
+#include <nmpp/parallel.hpp>
+
+namespace nmpp {
+
+struct tiled_policy
+{
+	explicit tiled_policy(size_t tile_width = 256, size_t tile_height = 32)
+		: tile_width(tile_width), tile_height(tile_height) { }
+	size_t tile_width, tile_height;
+};
+
+const tiled_policy tiled = tiled_policy();
+
+namespace detail {
+
+struct tile_region
+{
+	size_t x0, y0, x1, y1;
+};
+
+typedef std::vector< std::shared_ptr<void> > tile_scratch;
+
+template<class T>
+class window_matrix
+{
+public:
+	typedef T value_type;
+	typedef const T& reference;
+	typedef const T& const_reference;
+	typedef window_matrix<T> this_type;
+	typedef this_type matrix_ref;
+	typedef this_type matrix_const_ref;
+
+	window_matrix(const T* array, size_t pitch, const tile_region& region, size_t width, size_t height)
+		: _array(array), _pitch(pitch), _region(region), _width(width), _height(height) { }
+
+	const_reference operator()(size_t x, size_t y) const {
+		assert(x >= _region.x0 && x < _region.x1);
+		assert(y >= _region.y0 && y < _region.y1);
+		return _array[(y - _region.y0) * _pitch + (x - _region.x0)];
+	}
+	void read_row(size_t x, size_t y, size_t count, T* output) const {
+		assert(x >= _region.x0 && x + count <= _region.x1);
+		assert(y >= _region.y0 && y < _region.y1);
+		const T* row = _array + (y - _region.y0) * _pitch + (x - _region.x0);
+		std::copy(row, row + count, output);
+	}
+
+	size_t width() const { return _width; }
+	size_t height() const { return _height; }
+
+private:
+	const T* _array;
+	size_t _pitch;
+	tile_region _region;
+	size_t _width, _height;
+};
+
+template<class MatrixT>
+struct tile_reference
+{
+	typedef typename remove_const<typename const_matrix_ref<MatrixT>::type>::type type;
+};
+
+template<class MatrixT>
+struct tile_stage
+{
+	typedef typename tile_reference<MatrixT>::type type;
+	static type make(const MatrixT& matrix, const tile_region&, tile_scratch&) { return type(matrix); }
+};
+
+template<class LeftMatrixT, class RightMatrixT, class BinaryOpT>
+struct tile_stage< matrix_binary_op<LeftMatrixT, RightMatrixT, BinaryOpT> >
+{
+	typedef typename tile_reference<LeftMatrixT>::type left_type;
+	typedef typename tile_reference<RightMatrixT>::type right_type;
+	typedef matrix_binary_op<typename tile_stage<left_type>::type, typename tile_stage<right_type>::type, BinaryOpT> type;
+
+	static type make(const matrix_binary_op<LeftMatrixT, RightMatrixT, BinaryOpT>& matrix, const tile_region& region, tile_scratch& scratch) {
+		return type(tile_stage<left_type>::make(matrix.lhs(), region, scratch),
+			tile_stage<right_type>::make(matrix.rhs(), region, scratch), matrix.op());
+	}
+};
+
+template<class MatrixT, class UnaryOpT>
+struct tile_stage< matrix_unary_op<MatrixT, UnaryOpT> >
+{
+	typedef typename tile_reference<MatrixT>::type right_type;
+	typedef matrix_unary_op<typename tile_stage<right_type>::type, UnaryOpT> type;
+
+	static type make(const matrix_unary_op<MatrixT, UnaryOpT>& matrix, const tile_region& region, tile_scratch& scratch) {
+		return type(tile_stage<right_type>::make(matrix.rhs(), region, scratch), matrix.op());
+	}
+};
+
+template<class ExpressionT, class T>
+void copy_region(const ExpressionT& expression, const tile_region& region, T* output, size_t pitch)
+{
+	for (size_t y = region.y0; y < region.y1; ++y)
+		read_row(expression, region.x0, y, region.x1 - region.x0, output + (y - region.y0) * pitch);
+}
+
+template<class InputT, class KernelT>
+struct tile_stage< convolve_op<InputT, KernelT> >
+{
+	typedef typename tile_reference<InputT>::type input_type;
+	typedef typename tile_reference<KernelT>::type kernel_type;
+	typedef typename remove_const<typename InputT::value_type>::type value_type;
+	typedef convolve_op<window_matrix<value_type>, kernel_type> type;
+
+	static type make(const convolve_op<InputT, KernelT>& matrix, const tile_region& region, tile_scratch& scratch) {
+		typedef auto_matrix<value_type, recycled_allocation> buffer_type;
+		tile_region halo;
+		halo.x0 = region.x0 > matrix.anchor_x() ? region.x0 - matrix.anchor_x() : 0;
+		halo.y0 = region.y0 > matrix.anchor_y() ? region.y0 - matrix.anchor_y() : 0;
+		halo.x1 = std::min(matrix.width(), region.x1 + matrix.kernel().width() - 1 - matrix.anchor_x());
+		halo.y1 = std::min(matrix.height(), region.y1 + matrix.kernel().height() - 1 - matrix.anchor_y());
+
+		const std::shared_ptr<buffer_type> buffer = std::make_shared<buffer_type>(halo.x1 - halo.x0, halo.y1 - halo.y0);
+		scratch.push_back(buffer);
+		copy_region(tile_stage<input_type>::make(matrix.input(), halo, scratch), halo, buffer->get(), buffer->pitch());
+		return type(window_matrix<value_type>(buffer->get(), buffer->pitch(), halo, matrix.width(), matrix.height()),
+			matrix.kernel(), matrix.anchor_x(), matrix.anchor_y());
+	}
+};
+
+template<class InputT, class OutputT>
+void copy_tile(const InputT& input, OutputT& output, const tile_region& region)
+{
+	typedef typename remove_const<typename InputT::value_type>::type value_type;
+	typedef typename OutputT::value_type output_value;
+	value_type buffer[row_chunk_size];
+	for (size_t y = region.y0; y < region.y1; ++y) {
+		for (size_t x = region.x0; x < region.x1; x += row_chunk_size) {
+			const size_t count = std::min<size_t>(row_chunk_size, region.x1 - x);
+			read_row(input, x, y, count, buffer);
+			for (size_t i = 0; i < count; ++i)
+				output(x + i, y) = static_cast<output_value>(buffer[i]);
+		}
+	}
+}
+
+} // end namespace detail
+
+template<class InputT, class OutputT>
+void copy_matrix(const InputT& input, OutputT& output, tiled_policy policy)
+{
+	assert(input.width() <= output.width());
+	assert(input.height() <= output.height());
+	assert(policy.tile_width > 0 && policy.tile_height > 0);
+	NMPP_INSTRUMENT("copy_matrix(tiled)", input.width() * input.height(),
+		input.width() * input.height() * sizeof(typename InputT::value_type),
+		input.width() * input.height() * sizeof(typename OutputT::value_type));
+	const size_t width = input.width(), height = input.height();
+	const size_t tiles_x = (width + policy.tile_width - 1) / policy.tile_width;
+	const size_t tiles_y = (height + policy.tile_height - 1) / policy.tile_height;
+	thread_pool::global().run(tiles_x * tiles_y, [&](size_t tile) {
+		detail::tile_region region;
+		region.x0 = tile % tiles_x * policy.tile_width;
+		region.y0 = tile / tiles_x * policy.tile_height;
+		region.x1 = std::min(width, region.x0 + policy.tile_width);
+		region.y1 = std::min(height, region.y0 + policy.tile_height);
+		detail::tile_scratch scratch;
+		detail::copy_tile(detail::tile_stage<InputT>::make(input, region, scratch), output, region);
+	});
+}
+
+} // end namespace nmpp
+
+#endif // NMPP_TILED_HPP
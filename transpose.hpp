@@ -19,6 +19,8 @@
 #ifndef NMPP_TANSPOSE_HPP
 #define NMPP_TANSPOSE_HPP
 
+#include <cassert>
+#include <algorithm>
 #include <cstddef>
 
 #include <nmpp/util.hpp>
@@ -48,6 +50,10 @@ public:
 
 	reference operator()(size_t x, size_t y) { return _matrix(y, x); }
 	const_reference operator()(size_t x, size_t y) const { return _matrix(y, x); }
+	void read_row(size_t x, size_t y, size_t count, typename detail::remove_const<value_type>::type* output) const {
+		for (size_t i = 0; i < count; ++i)
+			output[i] = _matrix(y, x + i);
+	}
 
 	size_t width() const { return _matrix.height(); }
 	size_t height() const { return _matrix.width(); }
@@ -56,6 +62,58 @@ private:
 	target_reference _matrix;
 };
 
+enum { transpose_block = 32 };
+
+template<class InputT, class OutputT, class InputCategoryT, class OutputCategoryT>
+void transpose_blocks(const InputT& input, OutputT& output, InputCategoryT, OutputCategoryT)
+{
+	typedef typename OutputT::value_type output_value;
+	const size_t width = input.width(), height = input.height();
+	for (size_t by = 0; by < height; by += transpose_block) {
+		const size_t ey = std::min<size_t>(by + transpose_block, height);
+		for (size_t bx = 0; bx < width; bx += transpose_block) {
+			const size_t ex = std::min<size_t>(bx + transpose_block, width);
+			for (size_t x = bx; x < ex; ++x)
+				for (size_t y = by; y < ey; ++y)
+					output(y, x) = static_cast<output_value>(input(x, y));
+		}
+	}
+}
+
+template<class InputT, class OutputT>
+void transpose_blocks(const InputT& input, OutputT& output, dense_storage_tag, dense_storage_tag)
+{
+	typedef typename OutputT::value_type output_value;
+	const size_t width = input.width(), height = input.height();
+	const size_t in_pitch = input.pitch(), out_pitch = output.pitch();
+	for (size_t by = 0; by < height; by += transpose_block) {
+		const size_t ey = std::min<size_t>(by + transpose_block, height);
+		for (size_t bx = 0; bx < width; bx += transpose_block) {
+			const size_t ex = std::min<size_t>(bx + transpose_block, width);
+			for (size_t x = bx; x < ex; ++x) {
+				output_value* out = output.get() + x * out_pitch;
+				for (size_t y = by; y < ey; ++y)
+					out[y] = static_cast<output_value>(input.get()[y * in_pitch + x]);
+			}
+		}
+	}
+}
+
+template<class T>
+void transpose_square(T* array, size_t size, size_t pitch)
+{
+	using std::swap;
+	for (size_t by = 0; by < size; by += transpose_block) {
+		const size_t ey = std::min<size_t>(by + transpose_block, size);
+		for (size_t bx = by; bx < size; bx += transpose_block) {
+			const size_t ex = std::min<size_t>(bx + transpose_block, size);
+			for (size_t y = by; y < ey; ++y)
+				for (size_t x = std::max(bx, y + 1); x < ex; ++x)
+					swap(array[y * pitch + x], array[x * pitch + y]);
+		}
+	}
+}
+
 } // end namespace detail
 
 template<class MatrixT>
@@ -64,6 +122,23 @@ transpose(MatrixT& matrix) {
 	return detail::transpose_op<MatrixT>(matrix);
 }
 
+template<class InputT, class OutputT>
+void transpose(const InputT& input, OutputT& output)
+{
+	assert(input.width() <= output.height());
+	assert(input.height() <= output.width());
+	detail::transpose_blocks(input, output,
+		typename detail::storage_category<InputT>::type(),
+		typename detail::storage_category<OutputT>::type());
+}
+
+template<class MatrixT>
+void transpose_inplace(MatrixT& matrix)
+{
+	assert(matrix.width() == matrix.height());
+	detail::transpose_square(matrix.get(), matrix.width(), matrix.pitch());
+}
+
 } // end namespace nmpp
 
 #endif // NMPP_TANSPOSE_HPP
@@ -21,6 +21,7 @@
 
 #include <cstddef>
 #include <limits>
+#include <algorithm>
 
 #include <nmpp/util.hpp>
 
@@ -43,9 +44,27 @@ public:
 	uniform_matrix(const this_type& other) : _value(other._value) { }
 
 	const_reference operator()(size_t x, size_t y) const { (void)x; (void)y; return _value; }
+	void read_row(size_t x, size_t y, size_t count, value_type* output) const {
+		(void)x; (void)y;
+		std::fill(output, output + count, _value);
+	}
 
-	size_t width() { return std::numeric_limits<size_t>::max(); }
-	size_t height() { return std::numeric_limits<size_t>::max(); }
+	size_t width() const { return std::numeric_limits<size_t>::max(); }
+	size_t height() const { return std::numeric_limits<size_t>::max(); }
+
+private:
+	value_type _value;
+};
+
+template<class T, class CategoryT>
+struct row_cursor<uniform_matrix<T>, CategoryT>
+{
+	enum { value = true };
+	typedef T value_type;
+
+	row_cursor(const uniform_matrix<T>& matrix, size_t y) : _value(matrix(0, y)) { }
+
+	const value_type& operator[](size_t x) const { (void)x; return _value; }
 
 private:
 	value_type _value;
@@ -20,12 +20,22 @@
 #define NMPP_UPSAMPLE_HPP
 
 #include <cstddef>
+#include <algorithm>
+#include <complex>
+#include <limits>
+#include <vector>
+
+#include <nmpp/util.hpp>
+#include <nmpp/instrumentation.hpp>
 
 namespace nmpp {
 
 template<class InputT, class OutputT>
 void upsample_nearest(const InputT& input, OutputT& output)
 {
+	NMPP_INSTRUMENT("upsample_nearest", output.width() * output.height(),
+		input.width() * input.height() * sizeof(typename InputT::value_type),
+		output.width() * output.height() * sizeof(typename OutputT::value_type));
 	size_t xmul = output.width() / input.width();
 	size_t xextra = output.width() % input.width();
 	size_t xmissing = input.width() - xextra;
@@ -50,44 +60,180 @@ void upsample_nearest(const InputT& input, OutputT& output)
 	}
 }
 
+namespace detail {
+
+template<class T>
+struct bilinear_weight { typedef float type; };
+template<>
+struct bilinear_weight<double> { typedef double type; };
+template<>
+struct bilinear_weight<long double> { typedef long double type; };
+template<class T>
+struct bilinear_weight< std::complex<T> > : bilinear_weight<T> { };
+
+// Blends in floating point; integer inputs are blended as weight_type and
+// truncated on the final store.
+template<class T, class OutputT>
+struct bilinear_float
+{
+	typedef typename bilinear_weight<T>::type weight_type;
+	typedef typename if_c<std::numeric_limits<T>::is_integer, weight_type, T>::type blend_type;
+
+	static weight_type weight(size_t numerator, size_t denominator) {
+		return weight_type(numerator) / weight_type(denominator);
+	}
+	static blend_type horizontal(const T& a, const T& b, weight_type w) {
+		return blend_type(a) * (weight_type(1) - w) + blend_type(b) * w;
+	}
+	static OutputT vertical(const blend_type& a, const blend_type& b, weight_type w) {
+		return static_cast<OutputT>(a * (weight_type(1) - w) + b * w);
+	}
+};
+
+// Exact integer blend with weights in units of 2^-bits and a single
+// rounding at the end. bits is chosen so the vertical sum fits in 32 bits.
+template<class T, unsigned Bits>
+struct bilinear_fixed
+{
+	typedef unsigned int weight_type;
+	typedef unsigned int blend_type;
+	enum { bits = Bits, one = 1u << Bits };
+
+	static weight_type weight(size_t numerator, size_t denominator) {
+		return static_cast<weight_type>(((numerator << bits) + denominator / 2) / denominator);
+	}
+	static blend_type horizontal(T a, T b, weight_type w) {
+		return blend_type(a) * (one - w) + blend_type(b) * w;
+	}
+	static T vertical(blend_type a, blend_type b, weight_type w) {
+		return static_cast<T>((a * (one - w) + b * w + (1u << (2 * bits - 1))) >> (2 * bits));
+	}
+};
+
+template<class InputValueT, class OutputValueT>
+struct bilinear_engine { typedef bilinear_float<InputValueT, OutputValueT> type; };
+template<>
+struct bilinear_engine<unsigned char, unsigned char> { typedef bilinear_fixed<unsigned char, 11> type; };
+template<>
+struct bilinear_engine<unsigned short, unsigned short> { typedef bilinear_fixed<unsigned short, 8> type; };
+
+// Output i samples the source at i * (in - 1) / (out - 1), computed exactly
+// in integers so the position does not drift across wide rows.
+template<class EngineT>
+void bilinear_axis(size_t in, size_t out, std::vector<size_t>& first, std::vector<size_t>& second,
+		std::vector<typename EngineT::weight_type>& weights)
+{
+	first.resize(out);
+	second.resize(out);
+	weights.resize(out);
+	for (size_t i = 0; i < out; ++i) {
+		const size_t position = out > 1 ? i * (in - 1) : 0;
+		const size_t denominator = out > 1 ? out - 1 : 1;
+		first[i] = position / denominator;
+		second[i] = std::min(first[i] + 1, in - 1);
+		weights[i] = EngineT::weight(position % denominator, denominator);
+	}
+}
+
+template<class OutputT, class CategoryT = typename storage_category<OutputT>::type>
+class bilinear_row_writer
+{
+public:
+	typedef typename OutputT::value_type value_type;
+
+	bilinear_row_writer(OutputT& output, size_t width) : _output(output), _row(width) { }
+
+	value_type* row(size_t) { return &_row[0]; }
+	void commit(size_t y) {
+		for (size_t x = 0; x < _row.size(); ++x)
+			_output(x, y) = _row[x];
+	}
+
+private:
+	OutputT& _output;
+	std::vector<value_type> _row;
+};
+
+template<class OutputT>
+class bilinear_row_writer<OutputT, dense_storage_tag>
+{
+public:
+	typedef typename OutputT::value_type value_type;
+
+	bilinear_row_writer(OutputT& output, size_t) : _output(output) { }
+
+	value_type* row(size_t y) { return _output.get() + y * _output.pitch(); }
+	void commit(size_t) { }
+
+private:
+	OutputT& _output;
+};
+
+template<class EngineT, class T>
+void bilinear_horizontal(const T* source, const size_t* first, const size_t* second,
+		const typename EngineT::weight_type* weights, size_t width, typename EngineT::blend_type* output)
+{
+	for (size_t x = 0; x < width; ++x)
+		output[x] = EngineT::horizontal(source[first[x]], source[second[x]], weights[x]);
+}
+
+} // end namespace detail
+
+// Column positions and weights are computed once per call. Each source row
+// is blended horizontally once into one of two row buffers, and every output
+// row is a vertical blend of those two buffers; both inner loops run over
+// contiguous arrays so the compiler can vectorize them. uint8 and uint16
+// images whose output has the same type use an exact fixed-point blend that
+// rounds to nearest; other types blend in floating point as before.
 template<class InputT, class OutputT>
 void upsample_bilinear(const InputT& input, OutputT& output)
 {
-	float xstep = (float)(input.width()-1) / (float)(output.width()-1);
-	float ystep = (float)(input.height()-1) / (float)(output.height()-1);
-
-	float dy = 0.0f;
-	size_t row1 = 0;
-	size_t row2 = 1;
-	if (row2 >= input.height())
-		row2 = row1;
-	for (size_t outy = 0; outy < output.height(); ++outy) {
-		float dx = 0.0f;
-		size_t col1 = 0;
-		size_t col2 = 1;
-		if (col2 >= input.width())
-			col2 = col1;
-		for (size_t outx = 0; outx < output.width(); ++outx) {
-			output(outx, outy) =
-				(1-dy) * (1-dx) * input(col1, row1) +
-				(1-dy) * dx * input(col2, row1) +
-				dy * dx * input(col2, row2) +
-				dy * (1-dx) * input(col1, row2);
-			dx += xstep;
-			if (dx >= 1.0f) {
-				++col1; ++col2;
-				dx -= 1.0f;
-				if (col2 >= input.width())
-					col2 = col1;
-			}
+	typedef typename detail::remove_const<typename InputT::value_type>::type input_value;
+	typedef typename OutputT::value_type output_value;
+	typedef typename detail::bilinear_engine<input_value, output_value>::type engine;
+	typedef typename engine::weight_type weight_type;
+	typedef typename engine::blend_type blend_type;
+
+	NMPP_INSTRUMENT("upsample_bilinear", output.width() * output.height(),
+		input.width() * input.height() * sizeof(typename InputT::value_type),
+		output.width() * output.height() * sizeof(typename OutputT::value_type));
+
+	const size_t width = output.width();
+	const size_t height = output.height();
+	if (width == 0 || height == 0 || input.width() == 0 || input.height() == 0)
+		return;
+
+	std::vector<size_t> x0, x1, y0, y1;
+	std::vector<weight_type> wx, wy;
+	detail::bilinear_axis<engine>(input.width(), width, x0, x1, wx);
+	detail::bilinear_axis<engine>(input.height(), height, y0, y1, wy);
+
+	std::vector<input_value> source(input.width());
+	std::vector<blend_type> rows[2] = { std::vector<blend_type>(width), std::vector<blend_type>(width) };
+	size_t loaded[2] = { size_t(-1), size_t(-1) };
+	detail::bilinear_row_writer<OutputT> writer(output, width);
+
+	for (size_t y = 0; y < height; ++y) {
+		if (loaded[0] != y0[y] && loaded[1] == y0[y]) {
+			rows[0].swap(rows[1]);
+			std::swap(loaded[0], loaded[1]);
 		}
-		dy += ystep;
-		if (dy >= 1.0f) {
-			++row1; ++row2;
-			dy -= 1.0f;
-			if (row2 >= input.height())
-				row2 = row1;
+		for (size_t r = 0; r < 2; ++r) {
+			const size_t want = r == 0 ? y0[y] : y1[y];
+			if (loaded[r] == want)
+				continue;
+			detail::read_row(input, 0, want, input.width(), &source[0]);
+			detail::bilinear_horizontal<engine>(&source[0], &x0[0], &x1[0], &wx[0], width, &rows[r][0]);
+			loaded[r] = want;
 		}
+
+		const blend_type* top = &rows[0][0];
+		const blend_type* bottom = &rows[1][0];
+		const weight_type w = wy[y];
+		output_value* out = writer.row(y);
+		for (size_t x = 0; x < width; ++x)
+			out[x] = engine::vertical(top[x], bottom[x], w);
+		writer.commit(y);
 	}
 }
 
@@ -22,20 +22,11 @@
 #include <cassert>
 #include <algorithm>
 #include <cstddef>
+#include <complex>
 
-namespace nmpp {
+#include <nmpp/instrumentation.hpp>
 
-template<class InputT, class OutputT>
-void copy_matrix(const InputT& input, OutputT& output)
-{
-	assert(input.width() <= output.width());
-	assert(input.height() <= output.height());
-	for (size_t y = 0; y < input.height(); ++y) {
-		for (size_t x = 0; x < input.width(); ++x) {
-			output(x, y) = static_cast<typename OutputT::value_type>(input(x, y));
-		}
-	}
-}
+namespace nmpp {
 
 namespace detail {
 
@@ -44,16 +35,55 @@ struct add_const { typedef const T type; };
 template<class T>
 struct add_const<const T> { typedef T type; };
 
+template<class T>
+struct remove_const { typedef T type; };
+template<class T>
+struct remove_const<const T> { typedef T type; };
+
+template<class T1, class T2>
+struct is_same { enum { value = false }; };
+template<class T>
+struct is_same<T, T> { enum { value = true }; };
+
 template<class T>
 struct is_const { enum { value = false }; };
 template<class T>
 struct is_const<const T> { enum { value = true }; };
 
+template<class T>
+struct alignment_of {
+	struct padded { char c; T t; };
+	enum { value = sizeof(padded) - sizeof(T) };
+};
+
 template<bool B, class T1, class T2>
 struct if_c { typedef T1 type; };
 template<class T1, class T2>
 struct if_c<false, T1, T2> { typedef T2 type; };
 
+template<class T>
+struct accumulator { typedef T type; };
+template<>
+struct accumulator<char> { typedef int type; };
+template<>
+struct accumulator<signed char> { typedef int type; };
+template<>
+struct accumulator<unsigned char> { typedef unsigned int type; };
+template<>
+struct accumulator<short> { typedef int type; };
+template<>
+struct accumulator<unsigned short> { typedef unsigned int type; };
+template<>
+struct accumulator<int> { typedef long type; };
+template<>
+struct accumulator<unsigned int> { typedef unsigned long type; };
+template<>
+struct accumulator<float> { typedef double type; };
+template<class T>
+struct accumulator< std::complex<T> > { typedef std::complex<typename accumulator<T>::type> type; };
+template<class T>
+struct accumulator<const T> : accumulator<T> { };
+
 template<class MatrixT>
 struct matrix_ref {
 	typedef typename if_c<is_const<MatrixT>::value,
@@ -69,8 +99,212 @@ struct const_matrix_ref {
 	>::type type;
 };
 
+template<bool B>
+struct bool_c { enum { value = B }; };
+
+struct generic_storage_tag { };
+struct dense_storage_tag { };
+
+template<class MatrixT>
+struct has_storage_category {
+	typedef char yes;
+	typedef char (&no)[2];
+	template<class U> static yes test(typename U::storage_category*);
+	template<class U> static no test(...);
+	enum { value = sizeof(test<MatrixT>(0)) == sizeof(yes) };
+};
+
+template<class MatrixT, bool HasCategory = has_storage_category<MatrixT>::value>
+struct storage_category { typedef generic_storage_tag type; };
+template<class MatrixT>
+struct storage_category<MatrixT, true> { typedef typename MatrixT::storage_category type; };
+
+template<class MatrixT, class CategoryT = typename storage_category<MatrixT>::type>
+struct row_cursor
+{
+	enum { value = false };
+};
+
+template<class MatrixT>
+struct row_cursor<MatrixT, dense_storage_tag>
+{
+	enum { value = true };
+	typedef typename remove_const<typename MatrixT::value_type>::type value_type;
+
+	row_cursor(const MatrixT& matrix, size_t y) : _row(matrix.get() + y * matrix.pitch()) { }
+
+	const value_type& operator[](size_t x) const { return _row[x]; }
+
+private:
+	const value_type* _row;
+};
+
+template<class MatrixT>
+struct has_read_row {
+	typedef char yes;
+	typedef char (&no)[2];
+	typedef typename remove_const<MatrixT>::type matrix_type;
+	typedef typename remove_const<typename matrix_type::value_type>::type value_type;
+	template<class U, void (U::*)(size_t, size_t, size_t, value_type*) const> struct check;
+	template<class U> static yes test(check<U, &U::read_row>*);
+	template<class U> static no test(...);
+	enum { value = sizeof(test<matrix_type>(0)) == sizeof(yes) };
+};
+
+enum { row_chunk_size = 256 };
+
+template<class MatrixT>
+void read_row(const MatrixT& matrix, size_t x, size_t y, size_t count,
+		typename remove_const<typename MatrixT::value_type>::type* output, bool_c<true>)
+{
+	matrix.read_row(x, y, count, output);
+}
+
+template<class MatrixT>
+void read_row(const MatrixT& matrix, size_t x, size_t y, size_t count,
+		typename remove_const<typename MatrixT::value_type>::type* output, bool_c<false>)
+{
+	for (size_t i = 0; i < count; ++i)
+		output[i] = matrix(x + i, y);
+}
+
+template<class MatrixT>
+void read_row(const MatrixT& matrix, size_t x, size_t y, size_t count,
+		typename remove_const<typename MatrixT::value_type>::type* output)
+{
+	read_row(matrix, x, y, count, output, bool_c<has_read_row<MatrixT>::value>());
+}
+
+struct element_access_tag { };
+struct row_reader_access_tag { };
+struct row_cursor_access_tag { };
+
+template<class MatrixT>
+struct access_category {
+	typedef typename if_c<row_cursor<MatrixT>::value,
+		row_cursor_access_tag,
+		typename if_c<has_read_row<MatrixT>::value,
+			row_reader_access_tag,
+			element_access_tag
+		>::type
+	>::type type;
+};
+
+template<class InputT, class OutputT, class AccessT, class CategoryT>
+void copy_rows(const InputT& input, OutputT& output, size_t begin, size_t end, AccessT, CategoryT)
+{
+	for (size_t y = begin; y < end; ++y) {
+		for (size_t x = 0; x < input.width(); ++x) {
+			output(x, y) = static_cast<typename OutputT::value_type>(input(x, y));
+		}
+	}
+}
+
+template<class InputT, class OutputT>
+void copy_rows(const InputT& input, OutputT& output, size_t begin, size_t end, element_access_tag, dense_storage_tag)
+{
+	typedef typename OutputT::value_type output_value;
+	const size_t width = input.width();
+	for (size_t y = begin; y < end; ++y) {
+		output_value* out = output.get() + y * output.pitch();
+		for (size_t x = 0; x < width; ++x)
+			out[x] = static_cast<output_value>(input(x, y));
+	}
+}
+
+template<class InputT, class OutputT>
+void copy_rows(const InputT& input, OutputT& output, size_t begin, size_t end, row_cursor_access_tag, generic_storage_tag)
+{
+	typedef typename OutputT::value_type output_value;
+	const size_t width = input.width();
+	for (size_t y = begin; y < end; ++y) {
+		const row_cursor<InputT> in(input, y);
+		for (size_t x = 0; x < width; ++x)
+			output(x, y) = static_cast<output_value>(in[x]);
+	}
+}
+
+template<class InputT, class OutputT>
+void copy_rows(const InputT& input, OutputT& output, size_t begin, size_t end, row_cursor_access_tag, dense_storage_tag)
+{
+	typedef typename OutputT::value_type output_value;
+	const size_t width = input.width();
+	for (size_t y = begin; y < end; ++y) {
+		const row_cursor<InputT> in(input, y);
+		output_value* out = output.get() + y * output.pitch();
+		for (size_t x = 0; x < width; ++x)
+			out[x] = static_cast<output_value>(in[x]);
+	}
+}
+
+template<class InputT, class OutputT>
+void copy_rows(const InputT& input, OutputT& output, size_t begin, size_t end, row_reader_access_tag, generic_storage_tag)
+{
+	typedef typename remove_const<typename InputT::value_type>::type value_type;
+	typedef typename OutputT::value_type output_value;
+	const size_t width = input.width();
+	value_type buffer[row_chunk_size];
+	for (size_t y = begin; y < end; ++y) {
+		for (size_t x = 0; x < width; x += row_chunk_size) {
+			const size_t count = std::min<size_t>(row_chunk_size, width - x);
+			input.read_row(x, y, count, buffer);
+			for (size_t i = 0; i < count; ++i)
+				output(x + i, y) = static_cast<output_value>(buffer[i]);
+		}
+	}
+}
+
+template<class InputT, class T>
+void read_row_into(const InputT& input, size_t y, size_t width, T* output, bool_c<false>)
+{
+	typedef typename remove_const<typename InputT::value_type>::type value_type;
+	value_type buffer[row_chunk_size];
+	for (size_t x = 0; x < width; x += row_chunk_size) {
+		const size_t count = std::min<size_t>(row_chunk_size, width - x);
+		input.read_row(x, y, count, buffer);
+		for (size_t i = 0; i < count; ++i)
+			output[x + i] = static_cast<T>(buffer[i]);
+	}
+}
+
+template<class InputT, class T>
+void read_row_into(const InputT& input, size_t y, size_t width, T* output, bool_c<true>)
+{
+	input.read_row(0, y, width, output);
+}
+
+template<class InputT, class OutputT>
+void copy_rows(const InputT& input, OutputT& output, size_t begin, size_t end, row_reader_access_tag, dense_storage_tag)
+{
+	typedef typename remove_const<typename InputT::value_type>::type value_type;
+	typedef typename OutputT::value_type output_value;
+	const size_t width = input.width();
+	for (size_t y = begin; y < end; ++y)
+		read_row_into(input, y, width, output.get() + y * output.pitch(),
+			bool_c<is_same<value_type, output_value>::value>());
+}
+
+template<class InputT, class OutputT>
+void copy_rows(const InputT& input, OutputT& output, size_t begin, size_t end)
+{
+	copy_rows(input, output, begin, end,
+		typename access_category<InputT>::type(),
+		typename storage_category<OutputT>::type());
+}
+
 } // end namespace detail
 
+template<class InputT, class OutputT>
+void copy_matrix(const InputT& input, OutputT& output)
+{
+	assert(input.width() <= output.width());
+	assert(input.height() <= output.height());
+	NMPP_INSTRUMENT("copy_matrix", input.width() * input.height(),
+		input.width() * input.height() * sizeof(typename InputT::value_type),
+		input.width() * input.height() * sizeof(typename OutputT::value_type));
+	detail::copy_rows(input, output, 0, input.height());
+}
+
 } // end namespace nmpp
 
 #endif // NMPP_COPY_MATRIX_HPP
@@ -20,15 +20,14 @@
 #define NMPP_WEAK_MATRIX_HPP
 
 #include <cassert>
+#include <algorithm>
 #include <cstddef>
 
 #include <nmpp/util.hpp>
+#include <nmpp/allocation.hpp>
 
 namespace nmpp {
 
-template<class T>
-class auto_matrix;
-
 template<class T>
 class weak_matrix
 {
@@ -41,24 +40,40 @@ public:
 	typedef weak_matrix<T> this_type;
 	typedef this_type matrix_ref;
 	typedef weak_matrix<typename detail::add_const<T>::type> matrix_const_ref;
+	typedef detail::dense_storage_tag storage_category;
 
-	weak_matrix() : _array(0), _width(0), _height(0) { }
-	weak_matrix(array_type array, size_t width, size_t height) : _array(array), _width(width), _height(height) { }
-	weak_matrix(auto_matrix<T>& matrix) : _array(matrix.get()), _width(matrix.width()), _height(matrix.height()) { }
-	weak_matrix(const auto_matrix<T>& matrix) : _array(matrix.get()), _width(matrix.width()), _height(matrix.height()) { }
-	weak_matrix(const this_type& other) : _array(other._array), _width(other._width), _height(other._height) { }
+	weak_matrix() : _array(0), _width(0), _height(0), _pitch(0) { }
+	weak_matrix(array_type array, size_t width, size_t height)
+		: _array(array), _width(width), _height(height), _pitch(width) { }
+	weak_matrix(array_type array, size_t width, size_t height, size_t pitch)
+		: _array(array), _width(width), _height(height), _pitch(pitch) {
+		assert(_width <= _pitch || _height <= 1);
+	}
+	template<class AllocationT>
+	weak_matrix(auto_matrix<T, AllocationT>& matrix)
+		: _array(matrix.get()), _width(matrix.width()), _height(matrix.height()), _pitch(matrix.pitch()) { }
+	template<class AllocationT>
+	weak_matrix(const auto_matrix<T, AllocationT>& matrix)
+		: _array(matrix.get()), _width(matrix.width()), _height(matrix.height()), _pitch(matrix.pitch()) { }
+	weak_matrix(const this_type& other)
+		: _array(other._array), _width(other._width), _height(other._height), _pitch(other._pitch) { }
 
 	reference operator()(size_t x, size_t y) {
 		assert(_array != 0);
 		assert(x < _width);
 		assert(y < _height);
-		return _array[y * _width + x];
+		return _array[y * _pitch + x];
 	}
 	const_reference operator()(size_t x, size_t y) const {
 		assert(_array != 0);
 		assert(x < _width);
 		assert(y < _height);
-		return _array[y * _width + x];
+		return _array[y * _pitch + x];
+	}
+	void read_row(size_t x, size_t y, size_t count, typename detail::remove_const<value_type>::type* output) const {
+		assert(x + count <= _width);
+		assert(y < _height);
+		std::copy(_array + y * _pitch + x, _array + y * _pitch + x + count, output);
 	}
 
 	template<class SourceT>
@@ -71,23 +86,29 @@ public:
 		_array = rhs._array;
 		_width = rhs._width;
 		_height = rhs._height;
+		_pitch = rhs._pitch;
 		return *this;
 	}
 
 	void reset(array_type array, size_t width, size_t height) {
+		reset(array, width, height, width);
+	}
+	void reset(array_type array, size_t width, size_t height, size_t pitch) {
 		_array = array;
 		_width = width;
 		_height = height;
+		_pitch = pitch;
 	}
 
 	size_t width() const { return _width; }
 	size_t height() const { return _height; }
+	size_t pitch() const { return _pitch; }
 	array_type get() { return _array; }
 	const_array_type get() const { return _array; }
 
 private:
 	array_type _array;
-	size_t _width, _height;
+	size_t _width, _height, _pitch;
 };
 
 } // end namespace nmpp